@@ -1,4 +1,8 @@
 #include "3DData.h"
+#include "ConvexHull.h"
+#include "Parallel.h"
+#include <cstdint>
+#include <stdexcept>
 using namespace FormatConverter;
 //Default constructor sets the cached flag false
 FormatConverter::D3Data::D3Data() {
@@ -16,7 +20,8 @@ FormatConverter::D3Data::D3Data(size_t vert, size_t norm, size_t tc, size_t fc)
 const std::vector<CachedFace>& FormatConverter::D3Data::CachedFaces()
 {
 	if (faces_cached) return cached_faces;
-	//The space needed is known
+	//The space needed is known, old entries are from before the faces changed
+	cached_faces.clear();
 	cached_faces.reserve(faces.size());
 	CachedFace temp;
 	for (size_t i = 0; i < faces.size(); i++)
@@ -53,6 +58,94 @@ void FormatConverter::D3Data::NormalizeNormals()
 	}
 }
 
+//Clears the arrays without giving back their memory
+void FormatConverter::D3Data::Clear()
+{
+	vertices.clear();
+	normals.clear();
+	tcoords.clear();
+	faces.clear();
+	parts.clear();
+	cached_faces.clear();
+	faces_cached = false;
+}
+
+//Sums the reserved bytes of the arrays
+size_t FormatConverter::D3Data::MemoryUsage() const
+{
+	size_t bytes = vertices.capacity() * sizeof(Vertex)
+		+ normals.capacity() * sizeof(Normal)
+		+ tcoords.capacity() * sizeof(Tcoord)
+		+ faces.capacity() * sizeof(Face)
+		+ cached_faces.capacity() * sizeof(CachedFace)
+		+ parts.capacity() * sizeof(Part);
+	for (size_t i = 0; i < parts.size(); i++)
+		bytes += parts[i].name.capacity() + parts[i].material.capacity();
+	return bytes;
+}
+
+//Creates standalone data object from a part using temporary index maps
+D3Data FormatConverter::D3Data::ExtractPart(const Part & part) const
+{
+	std::vector<long> vertex_map, normal_map, tcoord_map;
+	return ExtractPart(part, vertex_map, normal_map, tcoord_map);
+}
+
+//Maps an index of the shared array into the compacted one, copying the element on first use
+//0 means missing data, so it is kept as is
+template <typename T>
+static long remap_index(long index, const std::vector<T>& source, std::vector<T>& target,
+	std::vector<long>& map, std::vector<long>& touched)
+{
+	if (index <= 0) return 0;
+	long& mapped = map[index - 1];
+	if (mapped == 0)
+	{
+		target.push_back(source[index - 1]);
+		mapped = (long)target.size();
+		touched.push_back(index - 1);
+	}
+	return mapped;
+}
+
+//Creates standalone data object from a part, the maps are zero filled again on return
+D3Data FormatConverter::D3Data::ExtractPart(const Part & part, std::vector<long>& vertex_map,
+	std::vector<long>& normal_map, std::vector<long>& tcoord_map) const
+{
+	D3Data result;
+	result.faces.reserve(part.face_count);
+	vertex_map.resize(vertices.size(), 0);
+	normal_map.resize(normals.size(), 0);
+	tcoord_map.resize(tcoords.size(), 0);
+	//Indexes set in the maps, so only these have to be cleared afterwards
+	std::vector<long> vtouched, ntouched, ttouched;
+
+	Face f;
+	for (size_t i = part.first_face; i < part.first_face + part.face_count; i++)
+	{
+		const Face& src = faces[i];
+		f.V1 = remap_index(src.V1, vertices, result.vertices, vertex_map, vtouched);
+		f.V2 = remap_index(src.V2, vertices, result.vertices, vertex_map, vtouched);
+		f.V3 = remap_index(src.V3, vertices, result.vertices, vertex_map, vtouched);
+		f.N1 = remap_index(src.N1, normals, result.normals, normal_map, ntouched);
+		f.N2 = remap_index(src.N2, normals, result.normals, normal_map, ntouched);
+		f.N3 = remap_index(src.N3, normals, result.normals, normal_map, ntouched);
+		f.T1 = remap_index(src.T1, tcoords, result.tcoords, tcoord_map, ttouched);
+		f.T2 = remap_index(src.T2, tcoords, result.tcoords, tcoord_map, ttouched);
+		f.T3 = remap_index(src.T3, tcoords, result.tcoords, tcoord_map, ttouched);
+		result.faces.push_back(f);
+	}
+
+	//Resetting the maps for the next call
+	for (size_t i = 0; i < vtouched.size(); i++) vertex_map[vtouched[i]] = 0;
+	for (size_t i = 0; i < ntouched.size(); i++) normal_map[ntouched[i]] = 0;
+	for (size_t i = 0; i < ttouched.size(); i++) tcoord_map[ttouched[i]] = 0;
+
+	//The result is a single part
+	result.parts.push_back(Part{ part.name, part.material, 0, result.faces.size() });
+	return result;
+}
+
 //Calculates normal of triangle with right hand rule, returns unit normal
 Normal FormatConverter::Utils::calculate_normal(const Vertex & a, const Vertex & b, const Vertex & c)
 {
@@ -61,6 +154,20 @@ Normal FormatConverter::Utils::calculate_normal(const Vertex & a, const Vertex &
 	return Normal{ u.y*v.z - u.z*v.y, u.z*v.x - u.x*v.z,u.x*v.y - u.y*v.x }.unit();
 }
 
+//Chooses the normal of a face for output
+Normal FormatConverter::Utils::face_normal(const CachedFace & face, char n_type)
+{
+	switch (n_type)
+	{
+	case '0':
+		return Normal{ 0, 0, 0 };
+	case 'a':
+		return average(*face.N1, *face.N2, *face.N3);
+	default:
+		return calculate_normal(*face.V1, *face.V2, *face.V3);
+	}
+}
+
 //Calculates cross product of two normals
 Normal FormatConverter::Utils::cross(const Normal & u, const Normal & v)
 {
@@ -70,7 +177,89 @@ Normal FormatConverter::Utils::cross(const Normal & u, const Normal & v)
 //Calculates average of three normals, returns unit normal
 Normal FormatConverter::Utils::average(const Normal & a, const Normal & b, const Normal & c)
 {
-	return Normal{ (a.x + b.x + c.x) / 3.f,(a.y + b.y + c.y) / 3.f ,(a.y + b.y + c.y) / 3.f }.unit();
+	return Normal{ (a.x + b.x + c.x) / 3.f,(a.y + b.y + c.y) / 3.f ,(a.z + b.z + c.z) / 3.f }.unit();
+}
+
+//A corner of a face with its vertex, the corners are grouped by vertex for the normals
+struct VertexCorner
+{
+	uint32_t vertex;
+	//face index * 3 + corner index
+	uint32_t corner;
+};
+
+//Weighted normal of a face at one of its corners
+static Vertex corner_normal(const D3Data& data, uint32_t corner, char weighting)
+{
+	const Face& f = data.faces[corner / 3];
+	long index[3] = { f.V1, f.V2, f.V3 };
+	int k = corner % 3;
+	const Vertex& a = data.vertices[index[k] - 1];
+	//The next and previous corner keep the orientation of the face
+	Vertex u = data.vertices[index[(k + 1) % 3] - 1] - a;
+	Vertex v = data.vertices[index[(k + 2) % 3] - 1] - a;
+	//The length of the cross product is twice the area of the face
+	Vertex n = u * v;
+	if (weighting != 'g') return n;
+	float length = n.length();
+	if (length == 0.f) return n;
+	float angle = atan2f(length, u.x*v.x + u.y*v.y + u.z*v.z);
+	return Vertex{ n.x / length * angle, n.y / length * angle, n.z / length * angle, 0 };
+}
+
+//Groups the face corners by vertex with a radix sort, then every thread sums the corners of its own vertices
+void FormatConverter::Utils::generate_normals(D3Data & data, char weighting, unsigned int thread_count)
+{
+	const size_t corners = data.faces.size() * 3;
+	if (data.vertices.size() > UINT32_MAX || corners > UINT32_MAX)
+		throw std::length_error("Too many vertices or faces for normal generation");
+
+	std::vector<VertexCorner> pairs(corners);
+	Parallel::for_ranges(data.faces.size(), thread_count, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			pairs[3 * i] = VertexCorner{ (uint32_t)(data.faces[i].V1 - 1), (uint32_t)(3 * i) };
+			pairs[3 * i + 1] = VertexCorner{ (uint32_t)(data.faces[i].V2 - 1), (uint32_t)(3 * i + 1) };
+			pairs[3 * i + 2] = VertexCorner{ (uint32_t)(data.faces[i].V3 - 1), (uint32_t)(3 * i + 2) };
+		}
+	});
+	Parallel::radix_sort(pairs, [](const VertexCorner& p) { return p.vertex; },
+		Parallel::bit_width(data.vertices.size()), thread_count);
+
+	data.normals.assign(data.vertices.size(), Normal{ 0, 0, 0 });
+	Parallel::for_ranges(corners, thread_count, [&](size_t begin, size_t end, size_t)
+	{
+		//Moving the range borders to vertex borders, so every vertex belongs to one thread
+		while (begin > 0 && begin < corners && pairs[begin].vertex == pairs[begin - 1].vertex) ++begin;
+		while (end > 0 && end < corners && pairs[end].vertex == pairs[end - 1].vertex) ++end;
+		size_t i = begin;
+		while (i < end)
+		{
+			uint32_t vertex = pairs[i].vertex;
+			Vertex sum{ 0, 0, 0, 0 };
+			for (; i < end && pairs[i].vertex == vertex; i++)
+			{
+				Vertex n = corner_normal(data, pairs[i].corner, weighting);
+				sum.x += n.x;
+				sum.y += n.y;
+				sum.z += n.z;
+			}
+			if (sum.length() > 0.f) data.normals[vertex] = Normal{ sum.x, sum.y, sum.z }.unit();
+		}
+	});
+
+	//The normals are indexed the same way as the vertices
+	Parallel::for_ranges(data.faces.size(), thread_count, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			data.faces[i].N1 = data.faces[i].V1;
+			data.faces[i].N2 = data.faces[i].V2;
+			data.faces[i].N3 = data.faces[i].V3;
+		}
+	});
+	data.faces_cached = false;
 }
 
 //Calculates surface of a face
@@ -125,6 +314,20 @@ float FormatConverter::Utils::calculate_volume(D3Data & data)
 	return fabsf(sum);
 }
 
+//Builds the convex hull of the vertices
+D3Data FormatConverter::Utils::convex_hull(const D3Data & data, unsigned int thread_count)
+{
+	ConvexHull hull(thread_count);
+	return hull.build(data);
+}
+
+//Builds the convex hull, then the box on it
+OrientedBox FormatConverter::Utils::oriented_bounding_box(const D3Data & data, unsigned int thread_count)
+{
+	ConvexHull hull(thread_count);
+	return hull.minimal_box(hull.build(data));
+}
+
 //Overload of - for substraction of two vertices
 Vertex FormatConverter::Vertex::operator-(const Vertex & rhs) const
 {
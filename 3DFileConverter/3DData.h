@@ -1,6 +1,7 @@
 #ifndef UNIQUE_3DData
 #define UNIQUE_3DData
 #include<vector>
+#include<string>
 
 namespace FormatConverter {
 	//Structs for storing 3D data
@@ -66,6 +67,37 @@ namespace FormatConverter {
 		long tcoord_index;
 	};
 
+	/*
+	Part of a mesh given by o or g lines in the source file.
+	It is only a range over the faces of the owning D3Data object,
+	the vertices, normals and texcoords are shared between parts.
+	*/
+	struct Part
+	{
+		std::string name;
+		//Material given by usemtl, a usemtl between the faces of a part
+		//splits it into two parts with the same name
+		std::string material;
+		size_t first_face;
+		size_t face_count;
+	};
+
+	/*
+	Box with any orientation, given by its center, three unit axes
+	(right handed) and the half sizes along the axes.
+	*/
+	struct OrientedBox
+	{
+		Vertex center;
+		Normal axes[3];
+		float extents[3];
+
+		float volume() const
+		{
+			return 8 * extents[0] * extents[1] * extents[2];
+		}
+	};
+
 	//Class for storing the 3D data
 	class D3Data{
 	private:
@@ -75,6 +107,8 @@ namespace FormatConverter {
 		std::vector<Normal> normals;
 		std::vector<Tcoord> tcoords;
 		std::vector<Face> faces;
+		//Empty if the source had no object/group information
+		std::vector<Part> parts;
 
 		bool faces_cached;
 
@@ -98,6 +132,34 @@ namespace FormatConverter {
 		*/
 		void NormalizeNormals();
 
+		/*
+		Removes all data and the cached faces, but keeps the reserved memory
+		of the arrays for reuse.
+		*/
+		void Clear();
+
+		/*
+		Bytes reserved by the stored data, including the cached faces.
+		Based on the capacity of the arrays, the heap overhead is not included.
+		*/
+		size_t MemoryUsage() const;
+
+		/*
+		Creates a standalone D3Data object from the faces of the given part.
+		Only the vertices, normals and texcoords used by the part are copied,
+		and the face indexes are remapped to the compacted arrays.
+		Indexes have to be positive (negative ones have to be fixed during loading).
+		*/
+		D3Data ExtractPart(const Part& part) const;
+
+		/*
+		Same as above, but uses the given index maps as scratch space, so they
+		can be reused between calls. The maps have to be empty or zero filled
+		with the size of the matching arrays, and they are left zero filled.
+		*/
+		D3Data ExtractPart(const Part& part, std::vector<long>& vertex_map,
+			std::vector<long>& normal_map, std::vector<long>& tcoord_map) const;
+
 	};
 
 	//Static utility class
@@ -107,6 +169,13 @@ namespace FormatConverter {
 		//Returns unit normals
 		static Normal calculate_normal(const Vertex& a, const Vertex& b, const Vertex& c);
 
+		/*
+		Returns the normal of a face for output by n_type, like in StlWriter
+		'0' means zero normal, 'a' means the average of the face normals (they must exist),
+		anything else means the normal calculated by the right hand rule
+		*/
+		static Normal face_normal(const CachedFace& face, char n_type);
+
 		//Calculates cross product of two normals
 		static Normal cross(const Normal& u, const Normal& v);
 
@@ -114,6 +183,18 @@ namespace FormatConverter {
 		//Returns unit normals
 		static Normal average(const Normal&a, const Normal& b, const Normal& c);
 
+		/*
+		Generates smooth vertex normals in parallel: one normal per vertex,
+		accumulated from the faces around it, and sets the N indexes of the faces.
+		Existing normals are replaced.
+		weighting 'a' weights the face normals by the area of the faces - this is the default
+		'g' weights them by the angle of the face at the vertex
+		Vertices without faces get zero normals. Face indexes have to be positive.
+		If thread_count is 0, the number of hardware threads is used.
+		Throws std::length_error if there are more than 2^32 vertices or face corners.
+		*/
+		static void generate_normals(D3Data& data, char weighting = 'a', unsigned int thread_count = 0);
+
 		//Calculates surface of triangle
 		static float calculate_surface(const CachedFace& c);
 
@@ -126,8 +207,22 @@ namespace FormatConverter {
 		//Calculates signed volume of a triangle given by its vertices
 		static float signed_volume_of_triangle(const Vertex& a, const Vertex& b, const Vertex& c);
 
+		/*
+		Returns the convex hull of the vertices as a mesh with outward oriented faces,
+		see ConvexHull. If thread_count is 0, the number of hardware threads is used.
+		Throws InvalidFormatException if all the vertices lie on one plane.
+		*/
+		static D3Data convex_hull(const D3Data& data, unsigned int thread_count = 0);
+
+		/*
+		Returns a small oriented bounding box of the vertices, built on the convex hull.
+		The boxes resting on each face of the hull are checked, see ConvexHull::minimal_box.
+		Throws InvalidFormatException if all the vertices lie on one plane.
+		*/
+		static OrientedBox oriented_bounding_box(const D3Data& data, unsigned int thread_count = 0);
+
 		//Calculates volume of mesh by calculating the signed volumes of tetrahedrons
-		//built on the triangles
+		//built on the triangles. Only meaningful for watertight meshes, see MeshValidator
 		static float calculate_volume(D3Data& data);
 	};
 }
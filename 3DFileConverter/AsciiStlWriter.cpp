@@ -0,0 +1,82 @@
+#include "AsciiStlWriter.h"
+#include "Parallel.h"
+#include "TextFormat.h"
+#include <cstring>
+#include <fstream>
+using namespace FormatConverter;
+
+//Stores the settings
+FormatConverter::AsciiStlWriter::AsciiStlWriter(unsigned int thread_count) : thread_count(thread_count)
+{
+}
+
+//Calls write with default settings
+bool FormatConverter::AsciiStlWriter::write(std::string & path, D3Data & data)
+{
+	return write(path, data, 'c');
+}
+
+//Opens the file and writes into it
+bool FormatConverter::AsciiStlWriter::write(std::string & path, D3Data & data, char n_type)
+{
+	//Binary mode, so the line endings are not converted
+	std::ofstream outfile(path, std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!outfile.is_open())
+		throw FileException();
+	write(outfile, data, n_type);
+	outfile.close();
+	return true;
+}
+
+//Calls the stream write with default settings
+bool FormatConverter::AsciiStlWriter::write(std::ostream & out, D3Data & data)
+{
+	return write(out, data, 'c');
+}
+
+//Appends a keyword and three floats
+static size_t write_triple(char* out, const char* keyword, size_t keyword_length, float x, float y, float z)
+{
+	memcpy(out, keyword, keyword_length);
+	size_t n = keyword_length;
+	n += TextFormat::float_to_chars(x, out + n);
+	out[n++] = ' ';
+	n += TextFormat::float_to_chars(y, out + n);
+	out[n++] = ' ';
+	n += TextFormat::float_to_chars(z, out + n);
+	out[n++] = '\n';
+	return n;
+}
+
+//Writes the facets, formatted in parallel
+bool FormatConverter::AsciiStlWriter::write(std::ostream & out, D3Data & data, char n_type)
+{
+	//Caching before the threads start, CachedFaces is not thread safe
+	const std::vector<CachedFace>& cachedData = data.CachedFaces();
+	if (data.normals.size() == 0) n_type = 'c';
+
+	const char header[] = "solid FormatConverter\n";
+	out.write(header, sizeof(header) - 1);
+	Parallel::write_ordered(out, cachedData.size(), chunk_size, thread_count,
+		[&](size_t begin, size_t end, std::string& buffer)
+	{
+		char facet[4 * (3 * TextFormat::max_length + 20) + 40];
+		for (size_t i = begin; i < end; i++)
+		{
+			const CachedFace& face = cachedData[i];
+			Normal normal = Utils::face_normal(face, n_type);
+			size_t n = write_triple(facet, "facet normal ", 13, normal.x, normal.y, normal.z);
+			memcpy(facet + n, "  outer loop\n", 13);
+			n += 13;
+			n += write_triple(facet + n, "    vertex ", 11, face.V1->x, face.V1->y, face.V1->z);
+			n += write_triple(facet + n, "    vertex ", 11, face.V2->x, face.V2->y, face.V2->z);
+			n += write_triple(facet + n, "    vertex ", 11, face.V3->x, face.V3->y, face.V3->z);
+			memcpy(facet + n, "  endloop\nendfacet\n", 19);
+			n += 19;
+			buffer.append(facet, n);
+		}
+	});
+	const char footer[] = "endsolid FormatConverter\n";
+	out.write(footer, sizeof(footer) - 1);
+	return true;
+}
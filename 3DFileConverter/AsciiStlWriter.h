@@ -0,0 +1,38 @@
+#ifndef UNIQUE_AsciiStlWriter
+#define UNIQUE_AsciiStlWriter
+#include "ConverterBase.h"
+namespace FormatConverter {
+	/*
+	Writes ascii stl files, for programs not reading the binary format.
+	Numbers are formatted with TextFormat (shortest form that reads back the same),
+	in parallel by ranges of faces, and written out in order.
+	*/
+	class AsciiStlWriter : public Writer {
+	public:
+		//If thread_count is 0, the number of hardware threads is used.
+		AsciiStlWriter(unsigned int thread_count = 0);
+
+		//Calls write with the default 'c' n_type
+		virtual bool write(std::string& path, D3Data& data);
+
+		/*
+		Writes an ascii stl file to the given path, n_type works like in StlWriter.
+		Throws FileException if not able to open file.
+		Returns true on successful writing.
+		*/
+		bool write(std::string& path, D3Data& data, char n_type);
+
+		//Stream versions of the functions above
+		virtual bool write(std::ostream& out, D3Data& data);
+		bool write(std::ostream& out, D3Data& data, char n_type);
+
+		//Writing into memory, see Writer
+		using Writer::write;
+
+	protected:
+		unsigned int thread_count;
+		//Faces formatted by a thread at once, see Parallel::write_ordered
+		static const size_t chunk_size = 16384;
+	};
+}
+#endif
@@ -0,0 +1,103 @@
+#include "BudgetedConverter.h"
+#include "ObjLoader.h"
+#include "StlWriter.h"
+#include "StreamingObjStlConverter.h"
+#include <fstream>
+using namespace FormatConverter;
+
+//Stores the settings
+FormatConverter::BudgetedConverter::BudgetedConverter(size_t budget_bytes, char n_type, bool triangulate)
+	: budget_bytes(budget_bytes), n_type(n_type), triangulate(triangulate)
+{
+}
+
+//Chooses the conversion path by the estimate and tracks the memory of the stages
+ConversionReport FormatConverter::BudgetedConverter::convert(std::string & in_path, std::string & out_path)
+{
+	ConversionReport report;
+	report.budget_bytes = budget_bytes;
+	report.estimated_bytes = estimate(in_path);
+	report.streamed = report.estimated_bytes > budget_bytes;
+
+	MemoryTracker tracker;
+	if (report.streamed)
+	{
+		tracker.begin_stage("stream");
+		StreamingObjStlConverter converter;
+		report.triangles = converter.convert(in_path, out_path, n_type, triangulate, &tracker);
+	}
+	else
+	{
+		//The loader registers the growth of the arrays and its buffers while reading,
+		//so the peak includes the old and new storage of reallocating arrays
+		tracker.begin_stage("load");
+		CheckedObjLoader loader;
+		loader.set_memory_tracker(&tracker);
+		D3Data data;
+		loader.load_into(in_path, data, true, false, triangulate);
+
+		//CachedFaces reserves the exact size once, so the size after the stage is its peak
+		tracker.begin_stage("cache");
+		size_t before = data.MemoryUsage();
+		data.CachedFaces();
+		tracker.resize(before, data.MemoryUsage());
+
+		tracker.begin_stage("write");
+		tracker.allocate(StlWriter::buffer_faces * StlWriter::face_record_size);
+		StlWriter writer;
+		writer.write(out_path, data, n_type);
+		tracker.release(StlWriter::buffer_faces * StlWriter::face_record_size);
+		report.triangles = data.faces.size();
+	}
+	report.stages = tracker.finish();
+	return report;
+}
+
+//Extrapolates the counts of the line types in the probe to the whole file
+size_t FormatConverter::BudgetedConverter::estimate(std::string & path)
+{
+	std::ifstream objfile(path, std::ios::binary | std::ios::ate);
+	if (!objfile.is_open())
+		throw FileException();
+	size_t file_size = (size_t)objfile.tellg();
+	objfile.seekg(0);
+
+	size_t vertices = 0, normals = 0, tcoords = 0, faces = 0;
+	size_t probed = 0;
+	std::string line;
+	//Obj files are ordered by line type, so the probe is taken from windows
+	//spread evenly over the file, not only from the start. Small files are read completely.
+	size_t windows = file_size <= probe_bytes ? 1 : probe_windows;
+	for (size_t w = 0; w < windows; w++)
+	{
+		size_t window_probed = 0;
+		objfile.clear();
+		objfile.seekg(file_size / windows * w);
+		//Skipping the partial line at the start of the window
+		if (w > 0) getline(objfile, line);
+		while (window_probed < probe_bytes / windows && getline(objfile, line))
+		{
+			window_probed += line.size() + 1;
+			if (line.size() < 2) continue;
+			if (line[0] == 'v' && line[1] == ' ') ++vertices;
+			else if (line[0] == 'v' && line[1] == 'n') ++normals;
+			else if (line[0] == 'v' && line[1] == 't') ++tcoords;
+			else if (line[0] == 'f' && line[1] == ' ')
+			{
+				//Polygons give more triangles if they are triangulated
+				size_t chunks = 1;
+				for (size_t i = 2; i < line.size(); i++)
+					if (line[i] == ' ' && i + 1 < line.size() && line[i + 1] != ' ') ++chunks;
+				faces += triangulate && chunks > 3 ? chunks - 2 : 1;
+			}
+		}
+		probed += window_probed;
+	}
+	if (probed == 0) return 0;
+
+	double scale = probed < file_size ? (double)file_size / probed : 1.0;
+	double bytes = vertices * sizeof(Vertex) + normals * sizeof(Normal)
+		+ tcoords * sizeof(Tcoord) + faces * (sizeof(Face) + sizeof(CachedFace));
+	//Vectors grow by doubling, so up to twice the size can be reserved
+	return (size_t)(bytes * scale * 2.0) + StlWriter::buffer_faces * StlWriter::face_record_size;
+}
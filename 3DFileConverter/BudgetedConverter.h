@@ -0,0 +1,57 @@
+#ifndef UNIQUE_BudgetedConverter
+#define UNIQUE_BudgetedConverter
+#include "MemoryTracker.h"
+#include <string>
+namespace FormatConverter {
+	//Result of a budgeted conversion
+	struct ConversionReport
+	{
+		//True if the low memory streaming path was used
+		bool streamed;
+		//Estimated bytes of loading the whole file into a D3Data object
+		size_t estimated_bytes;
+		size_t budget_bytes;
+		size_t triangles;
+		//Peak bytes of each stage, in order
+		std::vector<StageMemory> stages;
+	};
+
+	/*
+	Obj to binary stl conversion within a memory budget.
+	Before loading, the memory need is estimated from windows spread evenly over
+	the file (small files are read completely) and the file size. If it fits in the budget, the file is loaded with
+	CheckedObjLoader and written with StlWriter, otherwise it is converted
+	with StreamingObjStlConverter, which only keeps the vertices in memory.
+	*/
+	class BudgetedConverter {
+	public:
+		/*
+		budget_bytes is the memory allowed for the mesh data and buffers.
+		n_type and triangulate are passed to the writer and the loader.
+		*/
+		BudgetedConverter(size_t budget_bytes, char n_type = 'c', bool triangulate = false);
+
+		/*
+		Converts the obj on in_path into the stl on out_path.
+		Throws FileException and InvalidFormatException.
+		*/
+		ConversionReport convert(std::string& in_path, std::string& out_path);
+
+		/*
+		Estimates the bytes needed to load and write the given obj file in memory.
+		Counts the line types in probe_bytes of the file, read from windows
+		spread over the file, and scales them up to the file size.
+		Throws FileException if the file cannot be opened.
+		*/
+		size_t estimate(std::string& path);
+
+	protected:
+		size_t budget_bytes;
+		char n_type;
+		bool triangulate;
+		//Size of the probed part of the file
+		static const size_t probe_bytes = 1 << 20;
+		static const size_t probe_windows = 16;
+	};
+}
+#endif
@@ -0,0 +1,556 @@
+#include "ConversionDaemon.h"
+#include "ObjLoader.h"
+#include "StlWriter.h"
+#include "MemoryStream.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+using namespace FormatConverter;
+
+//Number of latencies kept for the percentiles
+static const size_t latency_window = 1024;
+//Longest accepted request line
+static const size_t max_request = 1 << 16;
+//Response for requests not finished within the timeout
+static const std::string timeout_response = "error\ttimeout";
+
+#ifndef _WIN32
+//Buffered reading from a connection, the bytes received after a line are kept for the next read
+class SocketReader
+{
+public:
+	SocketReader(int fd) : fd(fd), begin(0), end(0)
+	{
+	}
+
+	//Reads until a new line, the connection closes, or the line gets longer than max_request
+	bool read_line(std::string& line)
+	{
+		line.clear();
+		while (line.size() < max_request)
+		{
+			if (begin == end && !fill()) return !line.empty();
+			const char* start = buffer + begin;
+			const char* newline = (const char*)memchr(start, '\n', end - begin);
+			size_t length = newline ? newline - start : end - begin;
+			line.append(start, length);
+			begin += length;
+			if (newline)
+			{
+				++begin;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//Reads exactly size bytes, the buffered ones first. Returns false if the connection closes before
+	bool read_exact(char* data, size_t size)
+	{
+		size_t received = std::min(size, end - begin);
+		memcpy(data, buffer + begin, received);
+		begin += received;
+		while (received < size)
+		{
+			ssize_t n = recv(fd, data + received, size - received, 0);
+			if (n <= 0) return false;
+			received += n;
+		}
+		return true;
+	}
+
+private:
+	int fd;
+	char buffer[4096];
+	size_t begin;
+	size_t end;
+
+	//Reads the next bytes into the empty buffer
+	bool fill()
+	{
+		ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+		if (n <= 0) return false;
+		begin = 0;
+		end = (size_t)n;
+		return true;
+	}
+};
+
+//Bytes taken from a shared limit, they are given back when the object is destroyed
+class InputReservation
+{
+public:
+	InputReservation(std::atomic<size_t>& in_use) : in_use(in_use), bytes(0)
+	{
+	}
+
+	~InputReservation()
+	{
+		in_use -= bytes;
+	}
+
+	//Takes size more bytes, returns false if the total would go over limit
+	bool reserve(size_t size, size_t limit)
+	{
+		size_t used = in_use.load();
+		do
+		{
+			if (size > limit || used > limit - size) return false;
+		} while (!in_use.compare_exchange_weak(used, used + size));
+		bytes += size;
+		return true;
+	}
+
+private:
+	std::atomic<size_t>& in_use;
+	size_t bytes;
+};
+
+//Writes all bytes, returns false on a broken connection
+static bool write_all(int fd, const char* data, size_t size)
+{
+	size_t sent = 0;
+#ifdef MSG_NOSIGNAL
+	const int flags = MSG_NOSIGNAL;
+#else
+	const int flags = 0;
+#endif
+	while (sent < size)
+	{
+		ssize_t n = send(fd, data + sent, size - sent, flags);
+		if (n <= 0) return false;
+		sent += n;
+	}
+	return true;
+}
+
+//Writes the whole line, broken connections are ignored
+static void write_line(int fd, const std::string& line)
+{
+	std::string out = line + "\n";
+	write_all(fd, out.data(), out.size());
+}
+
+//Fills the socket address, throws FileException if the path is too long
+static sockaddr_un socket_address(const std::string& path)
+{
+	sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(addr.sun_path))
+		throw FileException("Socket path too long");
+	memcpy(addr.sun_path, path.c_str(), path.size());
+	return addr;
+}
+#endif
+
+//Splits the request line by tabs
+static std::vector<std::string> split_fields(const std::string& line)
+{
+	std::vector<std::string> fields;
+	size_t pos = 0;
+	size_t next;
+	while ((next = line.find('\t', pos)) != std::string::npos)
+	{
+		fields.push_back(line.substr(pos, next - pos));
+		pos = next + 1;
+	}
+	fields.push_back(line.substr(pos));
+	//Trailing carriage return from clients on other platforms
+	if (!fields.back().empty() && fields.back().back() == '\r') fields.back().pop_back();
+	return fields;
+}
+
+//Stores the settings, the socket is created in run
+FormatConverter::ConversionDaemon::ConversionDaemon(const std::string & socket_path, unsigned int worker_count,
+	size_t queue_limit, unsigned int timeout_ms, size_t retain_bytes, size_t max_input_bytes)
+	: socket_path(socket_path), worker_count(Parallel::thread_count(worker_count)), queue_limit(queue_limit),
+	timeout_ms(timeout_ms), retain_bytes(retain_bytes), max_input_bytes(max_input_bytes), input_bytes(0), listen_fd(-1), running(false),
+	counters(), latency_pos(0)
+{
+}
+
+//Stops the daemon if it is still running
+FormatConverter::ConversionDaemon::~ConversionDaemon()
+{
+	stop();
+}
+
+#ifdef _WIN32
+//Unix domain sockets are not available
+void FormatConverter::ConversionDaemon::run()
+{
+	throw FileException("Unix domain sockets are not supported on this platform");
+}
+
+void FormatConverter::ConversionDaemon::stop()
+{
+}
+
+void FormatConverter::ConversionDaemon::handle(Job & job, WorkerState & state)
+{
+}
+#else
+//Binds the socket, starts the workers and accepts connections until stopped
+void FormatConverter::ConversionDaemon::run()
+{
+	sockaddr_un addr = socket_address(socket_path);
+	listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listen_fd < 0)
+		throw FileException("Cannot create socket");
+	//Socket file left by a previous run
+	unlink(socket_path.c_str());
+	//Requests can read and write any file of the daemon's user, so only that user may connect.
+	//The mode is set before listening, no connection can be made before that
+	if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || chmod(socket_path.c_str(), S_IRUSR | S_IWUSR) < 0
+		|| listen(listen_fd, (int)queue_limit) < 0)
+	{
+		close(listen_fd);
+		listen_fd = -1;
+		throw FileException("Cannot bind socket");
+	}
+
+	started = std::chrono::steady_clock::now();
+	running = true;
+	//The workers are started once and kept warm
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < worker_count; i++)
+		workers.push_back(std::thread(&ConversionDaemon::worker_loop, this));
+
+	//Waiting time after running out of resources, doubled while it lasts
+	unsigned int backoff_ms = 0;
+	while (running)
+	{
+		int fd = accept(listen_fd, nullptr, nullptr);
+		if (fd < 0)
+		{
+			if (!running) break;
+			int error = errno;
+			//The client gave up before being accepted, or a signal arrived
+			if (error == EINTR || error == ECONNABORTED) continue;
+			std::cerr << "ConversionDaemon: accept failed: " << strerror(error) << std::endl;
+			//Out of descriptors or buffers, they may be freed by the running requests
+			if (error == EMFILE || error == ENFILE || error == ENOBUFS || error == ENOMEM)
+			{
+				backoff_ms = std::min(1000u, backoff_ms == 0 ? 10 : backoff_ms * 2);
+				std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+				continue;
+			}
+			//Anything else will not get better by retrying
+			running = false;
+			break;
+		}
+		backoff_ms = 0;
+		//Socket timeouts, so a slow client cannot block a worker
+		timeval tv;
+		tv.tv_sec = timeout_ms / 1000;
+		tv.tv_usec = (timeout_ms % 1000) * 1000;
+		setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+		setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+		std::unique_lock<std::mutex> lock(queue_mutex);
+		//Backpressure: the client has to retry later
+		if (queue.size() >= queue_limit)
+		{
+			lock.unlock();
+			write_line(fd, "busy");
+			close(fd);
+			std::lock_guard<std::mutex> stats_lock(stats_mutex);
+			counters.rejected++;
+			continue;
+		}
+		queue.push_back(Job{ fd, std::chrono::steady_clock::now() });
+		lock.unlock();
+		queue_cv.notify_one();
+	}
+
+	queue_cv.notify_all();
+	for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+	close(listen_fd);
+	listen_fd = -1;
+	unlink(socket_path.c_str());
+}
+
+//Wakes up the accept call and the workers
+void FormatConverter::ConversionDaemon::stop()
+{
+	if (!running.exchange(false)) return;
+	if (listen_fd >= 0) shutdown(listen_fd, SHUT_RDWR);
+	queue_cv.notify_all();
+}
+
+//Reads the request, executes it within the timeout, and responds
+void FormatConverter::ConversionDaemon::handle(Job & job, WorkerState & state)
+{
+	SocketReader reader(job.fd);
+	//Share of the in-memory input limit, given back when the request ends
+	InputReservation input(input_bytes);
+	std::string line;
+	if (!reader.read_line(line))
+	{
+		close(job.fd);
+		return;
+	}
+	std::vector<std::string> fields = split_fields(line);
+	bool in_memory = fields[0] == "convertmem";
+	bool conversion = in_memory || fields[0] == "convert";
+
+	//The obj bytes of an in-memory request follow the request line
+	if (in_memory)
+	{
+		size_t size = fields.size() > 1 ? strtoull(fields[1].c_str(), nullptr, 10) : 0;
+		if (size == 0 || size > max_input_bytes)
+		{
+			write_line(job.fd, "error\tinvalid input size");
+			close(job.fd);
+			return;
+		}
+		//The inputs of all workers together stay within max_input_bytes, the client can retry later
+		if (!input.reserve(size, max_input_bytes))
+		{
+			write_line(job.fd, "busy");
+			close(job.fd);
+			std::lock_guard<std::mutex> lock(stats_mutex);
+			counters.rejected++;
+			return;
+		}
+		try
+		{
+			state.input.resize(size);
+		}
+		//bad_alloc, or length_error above the largest possible vector
+		catch (const std::exception&)
+		{
+			write_line(job.fd, "error\tinput too large");
+			close(job.fd);
+			return;
+		}
+		if (!reader.read_exact(&state.input[0], size))
+		{
+			close(job.fd);
+			return;
+		}
+	}
+
+	//The timeout counts from accepting, requests already past it are not started,
+	//the running ones are stopped by the loader and the writer
+	auto deadline = job.accepted + std::chrono::milliseconds(timeout_ms);
+	size_t triangles = 0;
+	std::string response = conversion && std::chrono::steady_clock::now() > deadline
+		? timeout_response : execute(fields, state, triangles, deadline);
+	if (response == timeout_response)
+	{
+		write_line(job.fd, response);
+		close(job.fd);
+		std::lock_guard<std::mutex> lock(stats_mutex);
+		counters.timed_out++;
+		return;
+	}
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - job.accepted).count();
+	bool ok = response.compare(0, 2, "ok") == 0;
+	if (conversion)
+	{
+		if (ok) response += "\t" + std::to_string(ms);
+		record(ms, ok, triangles);
+	}
+	write_line(job.fd, response);
+	if (in_memory && ok) write_all(job.fd, state.output.data(), state.output.size());
+	close(job.fd);
+}
+#endif
+
+//Takes the connections one by one, the data object is kept between them
+void FormatConverter::ConversionDaemon::worker_loop()
+{
+	WorkerState state;
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(queue_mutex);
+			queue_cv.wait(lock, [&] { return !queue.empty() || !running; });
+			//Queued requests are still served after stopping
+			if (queue.empty()) return;
+			job = queue.front();
+			queue.pop_front();
+		}
+		handle(job, state);
+		//Not keeping the memory of an exceptionally big request
+		if (state.data.MemoryUsage() + state.input.capacity() + state.output.capacity() > retain_bytes)
+			state = WorkerState();
+	}
+}
+
+//Runs the request with the worker's own loader and writer
+std::string FormatConverter::ConversionDaemon::execute(const std::vector<std::string>& fields, WorkerState & state, size_t & triangles,
+	std::chrono::steady_clock::time_point deadline)
+{
+	if (fields[0] == "stats")
+	{
+		DaemonStats s = stats();
+		std::ostringstream out;
+		out << "ok\trequests=" << s.requests << "\tfailed=" << s.failed << "\trejected=" << s.rejected
+			<< "\ttimed_out=" << s.timed_out << "\ttriangles=" << s.triangles << "\tuptime_s=" << s.uptime_s
+			<< "\tavg_ms=" << s.avg_ms << "\tp50_ms=" << s.p50_ms << "\tp99_ms=" << s.p99_ms << "\tmax_ms=" << s.max_ms
+			<< "\trequests_per_s=" << (s.uptime_s > 0 ? s.requests / s.uptime_s : 0.0);
+		return out.str();
+	}
+	if (fields[0] == "shutdown")
+	{
+		stop();
+		return "ok";
+	}
+	bool in_memory = fields[0] == "convertmem";
+	if (!(in_memory && fields.size() >= 2) && !(fields[0] == "convert" && fields.size() >= 3))
+		return "error\tunknown request";
+
+	//Options come after the paths or the input size
+	size_t options = in_memory ? 2 : 3;
+	char n_type = fields.size() > options && !fields[options].empty() ? fields[options][0] : 'c';
+	bool triangulate = fields.size() > options + 1 && fields[options + 1] == "1";
+	try
+	{
+		CheckedObjLoader loader;
+		StlWriter writer;
+		loader.set_deadline(deadline);
+		writer.set_deadline(deadline);
+		if (in_memory)
+		{
+			//Parsing and writing in memory, the buffers of the worker are reused
+			MemoryInputBuffer in_buffer(state.input.data(), state.input.size());
+			std::istream in(&in_buffer);
+			loader.load_into(in, state.data, true, false, triangulate);
+			state.output.clear();
+			VectorOutputBuffer out_buffer(state.output);
+			std::ostream out(&out_buffer);
+			writer.write(out, state.data, n_type);
+			triangles = state.data.faces.size();
+			return "ok\t" + std::to_string(triangles) + "\t" + std::to_string(state.output.size());
+		}
+		std::string in_path = fields[1];
+		std::string out_path = fields[2];
+		loader.load_into(in_path, state.data, true, false, triangulate);
+		writer.write(out_path, state.data, n_type);
+		triangles = state.data.faces.size();
+		return "ok\t" + std::to_string(triangles);
+	}
+	catch (const TimeoutException&)
+	{
+		return timeout_response;
+	}
+	catch (const std::exception& ex)
+	{
+		std::string message = ex.what();
+		return "error\t" + (message.empty() ? std::string("conversion failed") : message);
+	}
+}
+
+//Updates the counters and the latency window
+void FormatConverter::ConversionDaemon::record(double ms, bool ok, size_t triangles)
+{
+	std::lock_guard<std::mutex> lock(stats_mutex);
+	counters.requests++;
+	if (!ok) counters.failed++;
+	counters.triangles += triangles;
+	counters.avg_ms += (ms - counters.avg_ms) / counters.requests;
+	counters.max_ms = std::max(counters.max_ms, ms);
+	if (latencies.size() < latency_window) latencies.push_back(ms);
+	else latencies[latency_pos] = ms;
+	latency_pos = (latency_pos + 1) % latency_window;
+}
+
+//Copies the counters and computes the percentiles of the latency window
+DaemonStats FormatConverter::ConversionDaemon::stats() const
+{
+	std::vector<double> sorted;
+	DaemonStats s;
+	{
+		std::lock_guard<std::mutex> lock(stats_mutex);
+		s = counters;
+		sorted = latencies;
+	}
+	s.uptime_s = running ? std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count() : 0;
+	std::sort(sorted.begin(), sorted.end());
+	s.p50_ms = sorted.empty() ? 0 : sorted[sorted.size() / 2];
+	s.p99_ms = sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+	return s;
+}
+
+//Stores the path of the daemon socket
+FormatConverter::DaemonClient::DaemonClient(const std::string & socket_path) : socket_path(socket_path)
+{
+}
+
+#ifdef _WIN32
+std::string FormatConverter::DaemonClient::request(const std::string & line)
+{
+	throw FileException("Unix domain sockets are not supported on this platform");
+}
+
+std::string FormatConverter::DaemonClient::convert(const char * obj, size_t size, std::vector<char>& stl,
+	char n_type, bool triangulate)
+{
+	throw FileException("Unix domain sockets are not supported on this platform");
+}
+#else
+//Opens a connection to the daemon
+static int connect_daemon(const std::string& path)
+{
+	sockaddr_un addr = socket_address(path);
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		throw FileException("Cannot create socket");
+	if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0)
+	{
+		close(fd);
+		throw FileException("Cannot connect to daemon");
+	}
+	return fd;
+}
+
+//Connects, sends the request and waits for the response line
+std::string FormatConverter::DaemonClient::request(const std::string & line)
+{
+	int fd = connect_daemon(socket_path);
+	write_line(fd, line);
+	SocketReader reader(fd);
+	std::string response;
+	reader.read_line(response);
+	close(fd);
+	return response;
+}
+
+//Sends the obj bytes after the request line, and reads the stl bytes after the response line
+std::string FormatConverter::DaemonClient::convert(const char * obj, size_t size, std::vector<char>& stl,
+	char n_type, bool triangulate)
+{
+	int fd = connect_daemon(socket_path);
+	write_line(fd, "convertmem\t" + std::to_string(size) + "\t" + n_type + "\t" + (triangulate ? "1" : "0"));
+	write_all(fd, obj, size);
+	SocketReader reader(fd);
+	std::string response;
+	reader.read_line(response);
+	stl.clear();
+	std::vector<std::string> fields = split_fields(response);
+	if (fields[0] == "ok" && fields.size() > 2)
+	{
+		stl.resize(strtoull(fields[2].c_str(), nullptr, 10));
+		if (!stl.empty() && !reader.read_exact(&stl[0], stl.size()))
+		{
+			close(fd);
+			throw FileException("Connection closed during the response");
+		}
+	}
+	close(fd);
+	return response;
+}
+#endif
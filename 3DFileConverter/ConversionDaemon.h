@@ -0,0 +1,146 @@
+#ifndef UNIQUE_ConversionDaemon
+#define UNIQUE_ConversionDaemon
+#include "3DData.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+namespace FormatConverter {
+	//Metrics of a running daemon
+	struct DaemonStats
+	{
+		size_t requests;
+		size_t failed;
+		//Rejected because the queue was full
+		size_t rejected;
+		//Not finished within the timeout, counted from accepting the connection
+		size_t timed_out;
+		size_t triangles;
+		double uptime_s;
+		//Latency of the conversion requests, from accepting to responding
+		double avg_ms;
+		double p50_ms;
+		double p99_ms;
+		double max_ms;
+	};
+
+	/*
+	Long running conversion server on a Unix domain socket.
+	A fixed pool of worker threads is started once, every worker keeps its own
+	loader, writer and D3Data object, so the memory of the previous requests is
+	reused. Only available on POSIX systems, on Windows run throws FileException.
+	Requests can read and write any file the daemon's user can, so the socket
+	is created with mode 0600: only that user can connect.
+
+	Every connection carries one request line with tab separated fields,
+	and gets one response line:
+		convert <in_path> <out_path> [n_type] [triangulate]
+			-> ok <triangles> <milliseconds> | error <message> | busy
+		convertmem <obj_bytes> [n_type] [triangulate], followed by the obj bytes
+			-> ok <triangles> <stl_bytes> <milliseconds>, followed by the stl bytes
+		stats -> ok requests=... failed=... (see DaemonStats)
+		shutdown -> ok, and the daemon stops after the running requests
+	*/
+	class ConversionDaemon {
+	public:
+		/*
+		worker_count of 0 means the number of hardware threads.
+		queue_limit is the number of waiting connections, above that the new ones
+		get busy right away. timeout_ms limits every socket read/write, and a conversion
+		request from accepting to finishing: requests past it are not started, the
+		running ones are stopped by the loader and the writer (see set_deadline) and
+		get error timeout. Worker data objects holding more than retain_bytes
+		after a request give back their memory. In-memory requests are limited to max_input_bytes,
+		and so are all of them together: above that the new ones get busy.
+		*/
+		ConversionDaemon(const std::string& socket_path, unsigned int worker_count = 0,
+			size_t queue_limit = 64, unsigned int timeout_ms = 30000, size_t retain_bytes = 256 << 20,
+			size_t max_input_bytes = 1 << 30);
+		~ConversionDaemon();
+
+		/*
+		Binds the socket and serves requests until stop is called or
+		a shutdown request arrives. Throws FileException if the socket cannot be created.
+		*/
+		void run();
+		//Stops accepting, run returns after the workers finished
+		void stop();
+
+		DaemonStats stats() const;
+
+	protected:
+		//An accepted connection waiting for a worker
+		struct Job
+		{
+			int fd;
+			std::chrono::steady_clock::time_point accepted;
+		};
+
+		std::string socket_path;
+		unsigned int worker_count;
+		size_t queue_limit;
+		unsigned int timeout_ms;
+		size_t retain_bytes;
+		size_t max_input_bytes;
+		//Input bytes of the running in-memory requests
+		std::atomic<size_t> input_bytes;
+
+		int listen_fd;
+		std::atomic<bool> running;
+		std::mutex queue_mutex;
+		std::condition_variable queue_cv;
+		std::deque<Job> queue;
+
+		mutable std::mutex stats_mutex;
+		DaemonStats counters;
+		//Latencies of the last requests for the percentiles
+		std::vector<double> latencies;
+		size_t latency_pos;
+		std::chrono::steady_clock::time_point started;
+
+		//Objects of a worker reused between its requests
+		struct WorkerState
+		{
+			D3Data data;
+			std::vector<char> input;
+			std::vector<char> output;
+		};
+
+		//Takes jobs from the queue until the daemon stops
+		void worker_loop();
+		//Reads the request of the job, executes it and responds
+		void handle(Job& job, WorkerState& state);
+		//Executes a parsed request, returns the response line, output bytes are left in state.output
+		std::string execute(const std::vector<std::string>& fields, WorkerState& state, size_t& triangles,
+			std::chrono::steady_clock::time_point deadline);
+		//Saves the metrics of a finished conversion request
+		void record(double ms, bool ok, size_t triangles);
+	};
+
+	//Client for sending single requests to a ConversionDaemon
+	class DaemonClient {
+	public:
+		DaemonClient(const std::string& socket_path);
+
+		/*
+		Sends the request line (fields separated by tabs) and returns the response line.
+		Throws FileException if the daemon cannot be reached.
+		*/
+		std::string request(const std::string& line);
+
+		/*
+		Converts the obj in memory with a convertmem request, the stl is stored in stl.
+		Returns the response line. Throws FileException if the daemon cannot be reached.
+		*/
+		std::string convert(const char* obj, size_t size, std::vector<char>& stl, char n_type = 'c',
+			bool triangulate = false);
+
+	protected:
+		std::string socket_path;
+	};
+}
+#endif
@@ -2,9 +2,35 @@
 #define UNIQUE_ConverterBase
 
 #include "3DData.h"
+#include "MemoryStream.h"
+#include <chrono>
 #include <exception>
+#include <istream>
+#include <ostream>
 #include <string>
 namespace FormatConverter {
+	//Exception for file handling
+	class FileException : public std::exception{
+		using std::exception::exception;
+	};
+
+	//Exception for signalling invalid format
+	class InvalidFormatException : public std::exception {
+		using std::exception::exception;
+	};
+
+	//Exception for loading or writing stopped at its deadline
+	class TimeoutException : public std::exception {
+		using std::exception::exception;
+	};
+
+	//Throws TimeoutException if the deadline has passed
+	inline void check_deadline(const std::chrono::steady_clock::time_point& deadline)
+	{
+		if (deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() > deadline)
+			throw TimeoutException("Deadline exceeded");
+	}
+
 	/*
 	Abstract base class for writers.
 	Has a virtual write function that has to be overriden.
@@ -16,7 +42,51 @@ namespace FormatConverter {
 		Throws FileException if the file given by path cannot be opened.
 		*/
 		virtual bool write(std::string& path, D3Data& data) = 0;
+
+		/*
+		Writes given data to the given stream, the file path version uses this too.
+		Binary formats need a stream opened in binary mode.
+		*/
+		virtual bool write(std::ostream& out, D3Data& data) = 0;
+
+		/*
+		Appends the written data to the end of the buffer, which grows as needed.
+		No file is involved.
+		*/
+		bool write(std::vector<char>& buffer, D3Data& data)
+		{
+			VectorOutputBuffer sb(buffer);
+			std::ostream out(&sb);
+			return write(out, data);
+		}
+
+		/*
+		Writes into the caller provided memory, returns the number of written bytes.
+		Throws FileException if the data does not fit.
+		*/
+		size_t write(char* buffer, size_t capacity, D3Data& data)
+		{
+			FixedOutputBuffer sb(buffer, capacity);
+			std::ostream out(&sb);
+			write(out, data);
+			if (!out) throw FileException("Output buffer too small");
+			return sb.written();
+		}
+
+		/*
+		Writing stops with TimeoutException after the given point in time, checked
+		between chunks of the output. time_point::max() turns it off, this is the default.
+		Only checked by writers supporting it (StlWriter).
+		*/
+		void set_deadline(std::chrono::steady_clock::time_point at)
+		{
+			deadline = at;
+		}
+
 		virtual ~Writer() {};
+
+	protected:
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
 	};
 	/*
 
@@ -32,17 +102,39 @@ namespace FormatConverter {
 		for the specific loader.
 		*/
 		virtual D3Data load(std::string& path) = 0;
+
+		/*
+		Loads from the given stream, the file path version uses this too.
+		Throws InvalidFormatException like the path version.
+		*/
+		virtual D3Data load(std::istream& in) = 0;
+
+		/*
+		Loads from a contiguous memory block, without copying it
+		or touching the filesystem.
+		*/
+		D3Data load(const char* data, size_t size)
+		{
+			MemoryInputBuffer sb(data, size);
+			std::istream in(&sb);
+			return load(in);
+		}
+
+		/*
+		Loading stops with TimeoutException after the given point in time, checked
+		between chunks of the input. time_point::max() turns it off, this is the default.
+		Only checked by loaders supporting it (CheckedObjLoader).
+		*/
+		void set_deadline(std::chrono::steady_clock::time_point at)
+		{
+			deadline = at;
+		}
+
 		virtual ~Loader() {};
-	};
 
-	//Exception for file handling
-	class FileException : public std::exception{
-		using std::exception::exception;
+	protected:
+		std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
 	};
 
-	//Exception for signalling invalid format
-	class InvalidFormatException : public std::exception {
-		using std::exception::exception;
-	};
 }
 #endif
@@ -0,0 +1,616 @@
+#include "ConvexHull.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+using namespace FormatConverter;
+
+//Vector in double precision, the hull is calculated in double to avoid most rounding problems
+struct Vec3
+{
+	double x, y, z;
+
+	Vec3 operator-(const Vec3& o) const { return Vec3{ x - o.x, y - o.y, z - o.z }; }
+	Vec3 operator+(const Vec3& o) const { return Vec3{ x + o.x, y + o.y, z + o.z }; }
+	Vec3 operator*(double s) const { return Vec3{ x * s, y * s, z * s }; }
+	double dot(const Vec3& o) const { return x * o.x + y * o.y + z * o.z; }
+	Vec3 cross(const Vec3& o) const { return Vec3{ y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x }; }
+	double length() const { return std::sqrt(dot(*this)); }
+};
+
+static Vec3 to_vec(const Vertex& v)
+{
+	return Vec3{ v.x, v.y, v.z };
+}
+
+//Triangle of the hull being built, with the points outside of it
+struct HullFace
+{
+	uint32_t v[3];
+	Vec3 normal;
+	double offset;
+	std::vector<uint32_t> outside;
+	bool alive;
+	//Visibility from the apex of the last expand that reached the face, 1 visible, 2 not
+	uint32_t stamp;
+	char visibility;
+};
+
+//State of one quickhull run
+class QuickHull
+{
+public:
+	QuickHull(const std::vector<Vertex>& points, unsigned int threads) : points(points), threads(threads),
+		point_count(points.size()), eps(0), visible_eps(0), stamp(0)
+	{
+	}
+
+	D3Data build(size_t& candidates);
+
+private:
+	const std::vector<Vertex>& points;
+	unsigned int threads;
+	uint64_t point_count;
+	//Points closer to a face than eps are not outside it
+	double eps;
+	//A face is replaced if the apex is farther above it than visible_eps, this is much
+	//smaller than eps, so nearly coplanar neighbours are replaced too and the hull stays convex
+	double visible_eps;
+	uint32_t stamp;
+	std::vector<HullFace> faces;
+	//Face by directed edge, a * point_count + b
+	std::unordered_map<uint64_t, uint32_t> edges;
+
+	//Sets below this size are assigned on the calling thread
+	static const size_t parallel_limit = 16384;
+
+	double distance(const HullFace& f, uint32_t p) const
+	{
+		return f.normal.dot(to_vec(points[p])) - f.offset;
+	}
+
+	uint32_t add_face(uint32_t a, uint32_t b, uint32_t c);
+	void remove_face(uint32_t f);
+	template <typename Score> uint32_t farthest(const std::vector<uint32_t>* among, Score score, double& best);
+	void assign(const uint32_t* list, size_t count, const std::vector<uint32_t>& targets,
+		const Vec3& center = Vec3{ 0, 0, 0 }, double radius = 0);
+	void expand(uint32_t face);
+};
+
+//Adds a face with outward normal by the right hand rule
+uint32_t QuickHull::add_face(uint32_t a, uint32_t b, uint32_t c)
+{
+	HullFace f;
+	f.v[0] = a;
+	f.v[1] = b;
+	f.v[2] = c;
+	Vec3 pa = to_vec(points[a]);
+	Vec3 n = (to_vec(points[b]) - pa).cross(to_vec(points[c]) - pa);
+	double length = n.length();
+	f.normal = length > 0 ? n * (1 / length) : n;
+	f.offset = f.normal.dot(pa);
+	f.alive = true;
+	f.stamp = 0;
+	f.visibility = 0;
+	uint32_t index = (uint32_t)faces.size();
+	faces.push_back(std::move(f));
+	edges[a * point_count + b] = index;
+	edges[b * point_count + c] = index;
+	edges[c * point_count + a] = index;
+	return index;
+}
+
+//Marks a face removed, its edges are overwritten or removed
+void QuickHull::remove_face(uint32_t f)
+{
+	HullFace& face = faces[f];
+	face.alive = false;
+	std::vector<uint32_t>().swap(face.outside);
+	for (int k = 0; k < 3; k++)
+	{
+		auto it = edges.find(face.v[k] * point_count + face.v[(k + 1) % 3]);
+		if (it != edges.end() && it->second == f) edges.erase(it);
+	}
+}
+
+//Point with the highest score, from the list or from all points in parallel
+template <typename Score>
+uint32_t QuickHull::farthest(const std::vector<uint32_t>* among, Score score, double& best)
+{
+	if (among)
+	{
+		uint32_t result = (*among)[0];
+		best = score(result);
+		for (size_t i = 1; i < among->size(); i++)
+		{
+			double s = score((*among)[i]);
+			if (s > best)
+			{
+				best = s;
+				result = (*among)[i];
+			}
+		}
+		return result;
+	}
+	std::vector<double> scores(Parallel::thread_count(threads), -DBL_MAX);
+	std::vector<uint32_t> results(scores.size(), 0);
+	size_t ranges = Parallel::for_ranges(points.size(), threads, [&](size_t begin, size_t end, size_t t)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			double s = score((uint32_t)i);
+			if (s > scores[t])
+			{
+				scores[t] = s;
+				results[t] = (uint32_t)i;
+			}
+		}
+	});
+	size_t winner = 0;
+	for (size_t t = 1; t < ranges; t++)
+		if (scores[t] > scores[winner]) winner = t;
+	best = scores[winner];
+	return results[winner];
+}
+
+//Gives every point to the first target face it is outside of, points inside all of them are dropped
+//A null list means all the points. Points inside the ball given by center and radius are dropped without testing
+void QuickHull::assign(const uint32_t* list, size_t count, const std::vector<uint32_t>& targets, const Vec3& center, double radius)
+{
+	const double radius2 = radius > 0 ? radius * radius : -1;
+	auto place = [&](uint32_t p) -> uint32_t
+	{
+		Vec3 offset = to_vec(points[p]) - center;
+		if (offset.dot(offset) < radius2) return UINT32_MAX;
+		for (size_t k = 0; k < targets.size(); k++)
+			if (distance(faces[targets[k]], p) > eps) return (uint32_t)k;
+		return UINT32_MAX;
+	};
+	if (count < parallel_limit)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			uint32_t p = list ? list[i] : (uint32_t)i;
+			uint32_t k = place(p);
+			if (k != UINT32_MAX) faces[targets[k]].outside.push_back(p);
+		}
+		return;
+	}
+
+	//Every range collects its own sets, then they are appended in range order
+	std::vector<std::vector<std::vector<uint32_t>>> sets(Parallel::thread_count(threads));
+	size_t ranges = Parallel::for_ranges(count, threads, [&](size_t begin, size_t end, size_t t)
+	{
+		std::vector<std::vector<uint32_t>>& own = sets[t];
+		own.resize(targets.size());
+		for (size_t i = begin; i < end; i++)
+		{
+			uint32_t p = list ? list[i] : (uint32_t)i;
+			uint32_t k = place(p);
+			if (k != UINT32_MAX) own[k].push_back(p);
+		}
+	});
+	Parallel::for_each(targets.size(), threads, [&](size_t k, size_t)
+	{
+		std::vector<uint32_t>& outside = faces[targets[k]].outside;
+		for (size_t t = 0; t < ranges; t++) outside.insert(outside.end(), sets[t][k].begin(), sets[t][k].end());
+	});
+}
+
+//Adds the farthest outside point of a face to the hull
+void QuickHull::expand(uint32_t face)
+{
+	std::vector<uint32_t>& outside = faces[face].outside;
+	uint32_t apex = outside[0];
+	double best = distance(faces[face], apex);
+	for (size_t i = 1; i < outside.size(); i++)
+	{
+		double d = distance(faces[face], outside[i]);
+		if (d > best)
+		{
+			best = d;
+			apex = outside[i];
+		}
+	}
+
+	//Faces seeing the apex, found through the neighbours of the starting face
+	++stamp;
+	std::vector<uint32_t> visible(1, face);
+	faces[face].stamp = stamp;
+	faces[face].visibility = 1;
+	std::vector<std::pair<uint32_t, uint32_t>> horizon;
+	for (size_t i = 0; i < visible.size(); i++)
+	{
+		const HullFace& f = faces[visible[i]];
+		for (int k = 0; k < 3; k++)
+		{
+			uint32_t a = f.v[k], b = f.v[(k + 1) % 3];
+			HullFace& neighbour = faces[edges.at(b * point_count + a)];
+			if (neighbour.stamp != stamp)
+			{
+				neighbour.stamp = stamp;
+				neighbour.visibility = distance(neighbour, apex) > visible_eps ? 1 : 2;
+				if (neighbour.visibility == 1) visible.push_back(edges.at(b * point_count + a));
+			}
+			if (neighbour.visibility == 2) horizon.push_back(std::make_pair(a, b));
+		}
+	}
+
+	//The points of the visible faces go to the new faces built on the horizon
+	std::vector<uint32_t> orphans;
+	for (size_t i = 0; i < visible.size(); i++)
+	{
+		std::vector<uint32_t>& points = faces[visible[i]].outside;
+		for (size_t k = 0; k < points.size(); k++)
+			if (points[k] != apex) orphans.push_back(points[k]);
+		remove_face(visible[i]);
+	}
+	std::vector<uint32_t> created;
+	for (size_t i = 0; i < horizon.size(); i++)
+		created.push_back(add_face(horizon[i].first, horizon[i].second, apex));
+	assign(orphans.data(), orphans.size(), created);
+}
+
+//Starting hull from extreme points, parallel filtering, then adding points until none is outside
+D3Data QuickHull::build(size_t& candidates)
+{
+	//Extremes in the directions of the axes, the square and the cube diagonals
+	const int direction_count = 26;
+	double directions[direction_count][3];
+	for (int i = 0, d = 0; i < 27; i++)
+	{
+		if (i == 13) continue;
+		directions[d][0] = i / 9 - 1;
+		directions[d][1] = i / 3 % 3 - 1;
+		directions[d][2] = i % 3 - 1;
+		++d;
+	}
+	const size_t threads_used = Parallel::thread_count(threads);
+	std::vector<double> best(threads_used * direction_count, -DBL_MAX);
+	std::vector<uint32_t> best_point(threads_used * direction_count, 0);
+	size_t ranges = Parallel::for_ranges(points.size(), threads, [&](size_t begin, size_t end, size_t t)
+	{
+		double* own = &best[t * direction_count];
+		uint32_t* own_point = &best_point[t * direction_count];
+		for (size_t i = begin; i < end; i++)
+		{
+			const Vertex& p = points[i];
+			for (int d = 0; d < direction_count; d++)
+			{
+				double s = directions[d][0] * p.x + directions[d][1] * p.y + directions[d][2] * p.z;
+				if (s > own[d])
+				{
+					own[d] = s;
+					own_point[d] = (uint32_t)i;
+				}
+			}
+		}
+	});
+	std::vector<uint32_t> extremes;
+	for (int d = 0; d < direction_count; d++)
+	{
+		size_t winner = d;
+		for (size_t t = 1; t < ranges; t++)
+			if (best[t * direction_count + d] > best[winner]) winner = t * direction_count + d;
+		extremes.push_back(best_point[winner]);
+	}
+	std::sort(extremes.begin(), extremes.end());
+	extremes.erase(std::unique(extremes.begin(), extremes.end()), extremes.end());
+
+	//Tolerance from the float precision of the coordinates
+	double size = 0;
+	for (size_t i = 0; i < extremes.size(); i++)
+	{
+		const Vertex& p = points[extremes[i]];
+		size = std::max(size, (double)std::fabs(p.x) + std::fabs(p.y) + std::fabs(p.z));
+	}
+	eps = 3 * size * FLT_EPSILON;
+	visible_eps = 16 * size * DBL_EPSILON;
+
+	//Tetrahedron: the two farthest extremes, the farthest from their line, then from their plane
+	uint32_t a = extremes[0], b = extremes[0];
+	double longest = -1;
+	for (size_t i = 0; i < extremes.size(); i++)
+		for (size_t j = i + 1; j < extremes.size(); j++)
+		{
+			double d = (to_vec(points[extremes[i]]) - to_vec(points[extremes[j]])).length();
+			if (d > longest)
+			{
+				longest = d;
+				a = extremes[i];
+				b = extremes[j];
+			}
+		}
+	Vec3 pa = to_vec(points[a]);
+	Vec3 line = to_vec(points[b]) - pa;
+	auto from_line = [&](uint32_t p) { return line.cross(to_vec(points[p]) - pa).length(); };
+	double d;
+	uint32_t c = farthest(&extremes, from_line, d);
+	if (!(d > eps * (longest > 0 ? longest : 1))) c = farthest(nullptr, from_line, d);
+	if (!(d > eps * (longest > 0 ? longest : 1)))
+		throw InvalidFormatException("The vertices are on one line, no convex hull");
+	Vec3 plane = line.cross(to_vec(points[c]) - pa);
+	plane = plane * (1 / plane.length());
+	auto from_plane = [&](uint32_t p) { return std::fabs(plane.dot(to_vec(points[p]) - pa)); };
+	uint32_t e = farthest(&extremes, from_plane, d);
+	if (!(d > eps)) e = farthest(nullptr, from_plane, d);
+	if (!(d > eps))
+		throw InvalidFormatException("The vertices are on one plane, no convex hull");
+	if (plane.dot(to_vec(points[e]) - pa) > 0) std::swap(b, c);
+	std::vector<uint32_t> targets;
+	targets.push_back(add_face(a, b, c));
+	targets.push_back(add_face(a, e, b));
+	targets.push_back(add_face(b, e, c));
+	targets.push_back(add_face(c, e, a));
+
+	//Hull of the extremes, everything inside it can be dropped
+	assign(extremes.data(), extremes.size(), targets);
+	std::vector<uint32_t> work = targets;
+	while (!work.empty())
+	{
+		uint32_t f = work.back();
+		work.pop_back();
+		if (!faces[f].alive || faces[f].outside.empty()) continue;
+		size_t first_new = faces.size();
+		expand(f);
+		for (size_t i = first_new; i < faces.size(); i++) work.push_back((uint32_t)i);
+	}
+	targets.clear();
+	for (size_t i = 0; i < faces.size(); i++)
+		if (faces[i].alive) targets.push_back((uint32_t)i);
+
+	//Most inner points fall into the biggest ball around the center of the extremes, they need one test only
+	Vec3 center = Vec3{ 0, 0, 0 };
+	for (size_t i = 0; i < extremes.size(); i++) center = center + to_vec(points[extremes[i]]);
+	center = center * (1.0 / extremes.size());
+	double radius = DBL_MAX;
+	for (size_t i = 0; i < targets.size(); i++) radius = std::min(radius, faces[targets[i]].offset - faces[targets[i]].normal.dot(center));
+	assign(nullptr, points.size(), targets, center, radius - eps);
+	candidates = 0;
+	for (size_t i = 0; i < targets.size(); i++) candidates += faces[targets[i]].outside.size();
+
+	//Quickhull on the remaining points
+	work = targets;
+	while (!work.empty())
+	{
+		uint32_t f = work.back();
+		work.pop_back();
+		if (!faces[f].alive || faces[f].outside.empty()) continue;
+		size_t first_new = faces.size();
+		expand(f);
+		for (size_t i = first_new; i < faces.size(); i++) work.push_back((uint32_t)i);
+	}
+
+	//Compacting the used vertices
+	D3Data hull;
+	std::unordered_map<uint32_t, long> index;
+	for (size_t i = 0; i < faces.size(); i++)
+	{
+		if (!faces[i].alive) continue;
+		long v[3];
+		for (int k = 0; k < 3; k++)
+		{
+			auto it = index.find(faces[i].v[k]);
+			if (it == index.end())
+			{
+				hull.vertices.push_back(points[faces[i].v[k]]);
+				it = index.insert(std::make_pair(faces[i].v[k], (long)hull.vertices.size())).first;
+			}
+			v[k] = it->second;
+		}
+		hull.faces.push_back(Face{ v[0], v[1], v[2], 0, 0, 0, 0, 0, 0 });
+	}
+	return hull;
+}
+
+//Stores the settings
+FormatConverter::ConvexHull::ConvexHull(unsigned int thread_count) : thread_count(thread_count), last_candidates(0)
+{
+}
+
+//Runs quickhull on the vertices
+D3Data FormatConverter::ConvexHull::build(const D3Data & data)
+{
+	if ((uint64_t)data.vertices.size() > UINT32_MAX)
+		throw std::length_error("Too many vertices for the convex hull");
+	if (data.vertices.size() < 4)
+		throw InvalidFormatException("Not enough vertices for a convex hull");
+	QuickHull quickhull(data.vertices, thread_count);
+	return quickhull.build(last_candidates);
+}
+
+//Point of the plane of the projection
+struct Point2D
+{
+	double x, y;
+};
+
+//Cross product of ab and ac
+static double turn(const Point2D& a, const Point2D& b, const Point2D& c)
+{
+	return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+//Counterclockwise convex hull with the monotone chain method, the points get sorted
+static void hull_2d(std::vector<Point2D>& points, std::vector<Point2D>& hull)
+{
+	std::sort(points.begin(), points.end(), [](const Point2D& a, const Point2D& b)
+	{
+		return a.x < b.x || (a.x == b.x && a.y < b.y);
+	});
+	hull.resize(2 * points.size());
+	size_t k = 0;
+	for (size_t i = 0; i < points.size(); i++)
+	{
+		while (k >= 2 && turn(hull[k - 2], hull[k - 1], points[i]) <= 0) --k;
+		hull[k++] = points[i];
+	}
+	for (size_t i = points.size() - 1, lower = k + 1; i > 0; i--)
+	{
+		while (k >= lower && turn(hull[k - 2], hull[k - 1], points[i - 1]) <= 0) --k;
+		hull[k++] = points[i - 1];
+	}
+	hull.resize(k > 1 ? k - 1 : k);
+}
+
+//Box resting on a plane, measured along its axes
+struct BoxCandidate
+{
+	double volume;
+	Vec3 axes[3];
+	double low[3];
+	double high[3];
+};
+
+//Smallest box with one side on the plane with normal n around the given points,
+//points and outline are scratch vectors. The volume is DBL_MAX if the projection is flat
+static BoxCandidate box_on_plane(const Vec3& n, const std::vector<Vertex>& vertices, size_t stride,
+	std::vector<Point2D>& points, std::vector<Point2D>& outline)
+{
+	BoxCandidate box;
+	box.volume = DBL_MAX;
+
+	//Basis of the plane, (u, v, n) is right handed
+	Vec3 helper = std::fabs(n.x) < 0.6 ? Vec3{ 1, 0, 0 } : Vec3{ 0, 1, 0 };
+	Vec3 u = n.cross(helper);
+	u = u * (1 / u.length());
+	Vec3 v = n.cross(u);
+	points.clear();
+	double low = DBL_MAX, high = -DBL_MAX;
+	for (size_t k = 0; k < vertices.size(); k += stride)
+	{
+		Vec3 p = to_vec(vertices[k]);
+		points.push_back(Point2D{ u.dot(p), v.dot(p) });
+		low = std::min(low, n.dot(p));
+		high = std::max(high, n.dot(p));
+	}
+	hull_2d(points, outline);
+	const std::vector<Point2D>& h = outline;
+	const size_t m = h.size();
+	if (m < 3) return box;
+
+	//Rotating calipers, the rectangle has a side on edge k of the outline
+	//The extremes only move forward around the outline
+	size_t right = 0, top = 0, left = 0;
+	for (size_t k = 0; k < m; k++)
+	{
+		const Point2D& p = h[k];
+		const Point2D& q = h[(k + 1) % m];
+		double length = std::sqrt((q.x - p.x) * (q.x - p.x) + (q.y - p.y) * (q.y - p.y));
+		if (length == 0) continue;
+		Point2D e = Point2D{ (q.x - p.x) / length, (q.y - p.y) / length };
+		Point2D inward = Point2D{ -e.y, e.x };
+		auto along = [&](size_t j, const Point2D& d) { return h[j % m].x * d.x + h[j % m].y * d.y; };
+		for (size_t step = 0; step < m && along(right + 1, e) > along(right, e); step++) right = (right + 1) % m;
+		if (k == 0) top = right;
+		for (size_t step = 0; step < m && along(top + 1, inward) > along(top, inward); step++) top = (top + 1) % m;
+		if (k == 0) left = top;
+		for (size_t step = 0; step < m && along(left + 1, e) < along(left, e); step++) left = (left + 1) % m;
+		double volume = (along(right, e) - along(left, e)) * (along(top, inward) - along(k, inward)) * (high - low);
+		if (volume < box.volume)
+		{
+			box.volume = volume;
+			box.axes[0] = u * e.x + v * e.y;
+			box.axes[1] = u * inward.x + v * inward.y;
+			box.axes[2] = n;
+			box.low[0] = along(left, e);
+			box.high[0] = along(right, e);
+			box.low[1] = along(k, inward);
+			box.high[1] = along(top, inward);
+			box.low[2] = low;
+			box.high[2] = high;
+		}
+	}
+	return box;
+}
+
+//Checks the boxes resting on the planes of the hull, first on a sample of the vertices
+OrientedBox FormatConverter::ConvexHull::minimal_box(const D3Data & hull)
+{
+	if (hull.faces.empty())
+		throw InvalidFormatException("The hull has no faces");
+
+	std::vector<Vec3> normals;
+	for (size_t i = 0; i < hull.faces.size(); i++)
+	{
+		const Face& f = hull.faces[i];
+		Vec3 a = to_vec(hull.vertices[f.V1 - 1]);
+		Vec3 n = (to_vec(hull.vertices[f.V2 - 1]) - a).cross(to_vec(hull.vertices[f.V3 - 1]) - a);
+		double length = n.length();
+		if (length > 0) normals.push_back(n * (1 / length));
+	}
+	if (normals.empty())
+		throw InvalidFormatException("The hull is flat, no bounding box");
+
+	//Faces of a flat region give the same box. Finely tessellated hulls have many almost
+	//parallel faces, then the normals are merged on a coarser grid until few enough remain
+	std::vector<Vec3> directions;
+	std::vector<std::pair<std::array<long long, 3>, size_t>> cells(normals.size());
+	for (double step = 1e-6; directions.empty() || directions.size() > max_directions; step *= 2)
+	{
+		for (size_t i = 0; i < normals.size(); i++)
+		{
+			cells[i].first[0] = (long long)std::floor(normals[i].x / step + 0.5);
+			cells[i].first[1] = (long long)std::floor(normals[i].y / step + 0.5);
+			cells[i].first[2] = (long long)std::floor(normals[i].z / step + 0.5);
+			cells[i].second = i;
+		}
+		std::sort(cells.begin(), cells.end());
+		directions.clear();
+		for (size_t i = 0; i < cells.size(); i++)
+			if (i == 0 || cells[i].first != cells[i - 1].first) directions.push_back(normals[cells[i].second]);
+	}
+
+	//Scoring every direction on a sample, then the best ones on all the vertices
+	const size_t threads = Parallel::thread_count(thread_count);
+	std::vector<std::vector<Point2D>> projected(threads), outline(threads);
+	const size_t stride = (hull.vertices.size() + sample_vertices - 1) / sample_vertices;
+	std::vector<BoxCandidate> boxes(directions.size());
+	Parallel::for_each(directions.size(), thread_count, [&](size_t i, size_t t)
+	{
+		boxes[i] = box_on_plane(directions[i], hull.vertices, stride, projected[t], outline[t]);
+	});
+	//Without sampling the boxes already contain all the vertices
+	if (stride > 1)
+	{
+		std::vector<std::pair<double, size_t>> scores(boxes.size());
+		for (size_t i = 0; i < boxes.size(); i++) scores[i] = std::make_pair(boxes[i].volume, i);
+		//std::min takes references, the in-class constant is copied so it needs no definition
+		size_t limit = refined_directions;
+		size_t kept = std::min(scores.size(), limit);
+		std::partial_sort(scores.begin(), scores.begin() + kept, scores.end());
+		std::vector<BoxCandidate> refined(kept);
+		Parallel::for_each(kept, thread_count, [&](size_t i, size_t t)
+		{
+			refined[i] = box_on_plane(directions[scores[i].second], hull.vertices, 1, projected[t], outline[t]);
+		});
+		boxes.swap(refined);
+	}
+	const BoxCandidate* winner = &boxes[0];
+	for (size_t i = 1; i < boxes.size(); i++)
+		if (boxes[i].volume < winner->volume) winner = &boxes[i];
+	if (winner->volume == DBL_MAX)
+		throw InvalidFormatException("The hull is flat, no bounding box");
+
+	//The projections are measured along the axes, the center is rebuilt from them
+	OrientedBox box;
+	Vec3 center = Vec3{ 0, 0, 0 };
+	for (int k = 0; k < 3; k++)
+	{
+		center = center + winner->axes[k] * ((winner->low[k] + winner->high[k]) / 2);
+		box.axes[k] = Normal{ (float)winner->axes[k].x, (float)winner->axes[k].y, (float)winner->axes[k].z };
+		box.extents[k] = (float)((winner->high[k] - winner->low[k]) / 2);
+	}
+	box.center = Vertex{ (float)center.x, (float)center.y, (float)center.z, 0 };
+	return box;
+}
+
+//Returns the filtered vertex count
+size_t FormatConverter::ConvexHull::candidates() const
+{
+	return last_candidates;
+}
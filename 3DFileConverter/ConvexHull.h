@@ -0,0 +1,53 @@
+#ifndef UNIQUE_ConvexHull
+#define UNIQUE_ConvexHull
+#include "ConverterBase.h"
+namespace FormatConverter {
+	/*
+	Convex hull and oriented bounding box of the vertices of a mesh, for packing parts.
+	The hull is built with quickhull. First the vertices extreme in 26 directions
+	give a small starting hull, then every vertex is tested against it in parallel:
+	vertices inside are dropped, the others are assigned to the faces they are
+	outside of. Reassigning big point sets after adding a hull vertex is parallel too.
+	Only the vertices are used, the faces of the mesh do not matter.
+	*/
+	class ConvexHull {
+	public:
+		//If thread_count is 0, the number of hardware threads is used.
+		ConvexHull(unsigned int thread_count = 0);
+
+		/*
+		Returns the hull as a mesh of the hull vertices and outward oriented triangles.
+		Flat regions of the hull are triangulated, points closer to the hull than the
+		float precision of the coordinates are treated as inside.
+		Throws InvalidFormatException if all the vertices lie on one plane,
+		std::length_error if there are more than 2^32 vertices.
+		*/
+		D3Data build(const D3Data& data);
+
+		/*
+		Returns the smallest box resting on a face of the hull returned by build.
+		For every distinct face plane the hull is projected onto the plane, and the
+		smallest rectangle around the projection is found with rotating calipers.
+		The optimal box usually touches a hull face, the exact method (also checking
+		boxes touching two hull edges only) is cubic in the hull size.
+		Big hulls are first scored on a sample of their vertices with the almost parallel
+		faces merged, then the best directions are checked with all the vertices,
+		so the box always contains the hull.
+		Throws InvalidFormatException if the hull has no faces.
+		*/
+		OrientedBox minimal_box(const D3Data& hull);
+
+		//Number of vertices left after testing against the starting hull at the last build
+		size_t candidates() const;
+
+	protected:
+		unsigned int thread_count;
+		size_t last_candidates;
+
+		//Limits of the box search on big hulls
+		static const size_t max_directions = 2048;
+		static const size_t sample_vertices = 2048;
+		static const size_t refined_directions = 16;
+	};
+}
+#endif
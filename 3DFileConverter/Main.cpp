@@ -1,15 +1,196 @@
+#include <chrono>
 #include <iostream>
+#include <random>
 #include <string>
 #include <time.h>
 #include <vector>
 #include "3DData.h"
 #include "ObjLoader.h"
 #include "StlWriter.h"
+#include "ConversionDaemon.h"
+#include "MeshValidator.h"
+#include "ConvexHull.h"
+#include "Parallel.h"
 using namespace std;
 using namespace FormatConverter;
 
-int main()
+/*
+Daemon mode: 3DFileConverter daemon <socket> [workers]
+Client mode: 3DFileConverter client <socket> <request fields...>
+The socket is only accessible by the user running the daemon (mode 0600),
+because requests can read and write any file of that user.
+*/
+int daemon_main(int argc, char* argv[])
 {
+	try
+	{
+		if (string(argv[1]) == "daemon")
+		{
+			ConversionDaemon daemon(argv[2], argc > 3 ? stoi(argv[3]) : 0);
+			daemon.run();
+		}
+		else
+		{
+			//The fields of the request are the rest of the arguments
+			string request;
+			for (int i = 3; i < argc; i++)
+				request += (i > 3 ? "\t" : "") + string(argv[i]);
+			DaemonClient client(argv[2]);
+			cout << client.request(request) << endl;
+		}
+	}
+	catch (const std::exception& ex)
+	{
+		cout << ex.what() << endl;
+		return 1;
+	}
+	return 0;
+}
+
+//Creates an obj in memory with a grid of size x size vertices and the given face layout
+string synthetic_obj(int size, const string& layout)
+{
+	string obj;
+	for (int i = 0; i < size; i++)
+		for (int j = 0; j < size; j++)
+			obj += "v " + to_string(i) + " " + to_string(j) + " 0\nvt 0.5 0.5\nvn 0 0 1\n";
+	for (int i = 0; i + 1 < size; i++)
+	{
+		for (int j = 0; j + 1 < size; j++)
+		{
+			int a = i * size + j + 1;
+			int corners[2][3] = { { a, a + 1, a + size + 1 }, { a, a + size + 1, a + size } };
+			for (int f = 0; f < 2; f++)
+			{
+				obj += "f";
+				for (int c = 0; c < 3; c++)
+				{
+					string v = to_string(corners[f][c]);
+					if (layout == "v") obj += " " + v;
+					else if (layout == "v/t") obj += " " + v + "/" + v;
+					else if (layout == "v//n") obj += " " + v + "//" + v;
+					else obj += " " + v + "/" + v + "/" + v;
+				}
+				obj += "\n";
+			}
+		}
+	}
+	return obj;
+}
+
+/*
+Benchmark mode: 3DFileConverter benchmark [grid size]
+Compares the generic and the layout specific face parsing for each layout
+*/
+int benchmark_main(int argc, char* argv[])
+{
+	try
+	{
+		int size = argc > 2 ? stoi(argv[2]) : 500;
+		const string layouts[4] = { "v", "v/t", "v//n", "v/t/n" };
+		for (int l = 0; l < 4; l++)
+		{
+			string obj = synthetic_obj(size, layouts[l]);
+			double times[2];
+			for (int fast = 0; fast < 2; fast++)
+			{
+				CheckedObjLoader ol = CheckedObjLoader();
+				ol.set_fast_face_parsing(fast == 1);
+				clock_t t1 = clock();
+				D3Data inmem = ol.load(obj.data(), obj.size());
+				times[fast] = ((float)clock() - (float)t1) / CLOCKS_PER_SEC;
+			}
+			cout << "Layout " << layouts[l] << ": generic " << times[0] << " s, specialized " << times[1]
+				<< " s, speedup " << times[0] / times[1] << endl;
+		}
+	}
+	catch (const std::exception& ex)
+	{
+		cout << ex.what() << endl;
+		return 1;
+	}
+	return 0;
+}
+
+/*
+Hull mode: 3DFileConverter hull <obj file | vertex count> [threads]
+Times the convex hull and the oriented bounding box of an obj file, or of
+the given number of random vertices in a ball (the faces do not matter for the hull).
+The timing is done on one thread, then on the given number of threads (default: all hardware threads).
+*/
+int hull_main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		cout << "Usage: 3DFileConverter hull <obj file | vertex count> [threads]" << endl;
+		return 1;
+	}
+	try
+	{
+		string source = argv[2];
+		D3Data data;
+		if (source.find_first_not_of("0123456789") == string::npos)
+		{
+			size_t count = stoull(source);
+			mt19937 generator(1);
+			uniform_real_distribution<float> coordinate(-1.f, 1.f);
+			data.vertices.reserve(count);
+			while (data.vertices.size() < count)
+			{
+				Vertex v = Vertex{ coordinate(generator), coordinate(generator), coordinate(generator), 0 };
+				if (v.length() <= 1.f) data.vertices.push_back(v);
+			}
+		}
+		else
+		{
+			CheckedObjLoader ol = CheckedObjLoader();
+			ol.load_into(source, data);
+		}
+
+		typedef chrono::steady_clock Clock;
+		unsigned int threads = Parallel::thread_count(argc > 3 ? stoi(argv[3]) : 0);
+		vector<unsigned int> runs = { 1 };
+		if (threads > 1) runs.push_back(threads);
+		double single[2] = { 0, 0 };
+		for (size_t r = 0; r < runs.size(); r++)
+		{
+			ConvexHull ch = ConvexHull(runs[r]);
+			Clock::time_point t1 = Clock::now();
+			D3Data hull = ch.build(data);
+			Clock::time_point t2 = Clock::now();
+			OrientedBox box = ch.minimal_box(hull);
+			Clock::time_point t3 = Clock::now();
+			double times[2] = { chrono::duration<double>(t2 - t1).count(), chrono::duration<double>(t3 - t2).count() };
+			if (r == 0)
+			{
+				single[0] = times[0];
+				single[1] = times[1];
+				cout << "Vertices: " << data.vertices.size() << ", after filtering: " << ch.candidates()
+					<< ", on the hull: " << hull.vertices.size() << ", hull volume: " << Utils::calculate_volume(hull) << endl;
+				cout << "Box size: " << 2 * box.extents[0] << " x " << 2 * box.extents[1] << " x " << 2 * box.extents[2]
+					<< ", volume: " << box.volume() << endl;
+			}
+			cout << "Threads: " << runs[r] << ", hull time: " << times[0] << " s (speedup " << single[0] / times[0]
+				<< "), box time: " << times[1] << " s (speedup " << single[1] / times[1] << ")" << endl;
+		}
+	}
+	catch (const std::exception& ex)
+	{
+		cout << ex.what() << endl;
+		return 1;
+	}
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1 && string(argv[1]) == "hull")
+		return hull_main(argc, argv);
+	if (argc > 2 && (string(argv[1]) == "daemon" || string(argv[1]) == "client"))
+		return daemon_main(argc, argv);
+	if (argc > 1 && string(argv[1]) == "benchmark")
+		return benchmark_main(argc, argv);
+
 	cout << "Testing converter with an obj of a cube made from rectangles" << endl;
 	try
 	{
@@ -24,7 +205,9 @@ int main()
 
 		cout << "Calculated statistics:" << endl;
 		cout << "Surface area of base 2 cube: " << Utils::calculate_surface_area(inmem) << endl;
-		cout << "Volume of base 2 cube: " << Utils::calculate_volume(inmem) << endl;
+		//The volume is only printed for watertight meshes
+		MeshValidator mv = MeshValidator();
+		cout << "Volume of base 2 cube: " << mv.checked_volume(inmem) << endl;
 
 		StlWriter sw = StlWriter();
 		sw.write(std::string("mycube.stl"), inmem);
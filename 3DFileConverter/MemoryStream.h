@@ -0,0 +1,122 @@
+#ifndef UNIQUE_MemoryStream
+#define UNIQUE_MemoryStream
+#include <algorithm>
+#include <streambuf>
+#include <vector>
+namespace FormatConverter {
+	/*
+	Read only stream buffer over a contiguous memory block.
+	The memory is not copied, it has to stay valid while the buffer is used.
+	Use it with std::istream.
+	*/
+	class MemoryInputBuffer : public std::streambuf {
+	public:
+		MemoryInputBuffer(const char* data, size_t size)
+		{
+			char* begin = const_cast<char*>(data);
+			setg(begin, begin, begin + size);
+		}
+
+	protected:
+		//Seeking is needed for stream positions, like tellg and seekg
+		virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+		{
+			char* target = (dir == std::ios_base::beg ? eback() : dir == std::ios_base::cur ? gptr() : egptr()) + off;
+			if (!(which & std::ios_base::in) || target < eback() || target > egptr()) return pos_type(off_type(-1));
+			setg(eback(), target, egptr());
+			return pos_type(target - eback());
+		}
+		virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which)
+		{
+			return seekoff(off_type(pos), std::ios_base::beg, which);
+		}
+	};
+
+	/*
+	Stream buffer appending to a growable vector.
+	The written bytes are appended to the end of the given vector.
+	Use it with std::ostream.
+	*/
+	class VectorOutputBuffer : public std::streambuf {
+	public:
+		VectorOutputBuffer(std::vector<char>& target) : target(target), start(target.size())
+		{
+		}
+
+	protected:
+		std::vector<char>& target;
+		//Size of the vector before writing, positions are relative to it
+		size_t start;
+		//Position of the next write, relative to start
+		size_t position = 0;
+
+		virtual int_type overflow(int_type c)
+		{
+			if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+			char ch = traits_type::to_char_type(c);
+			xsputn(&ch, 1);
+			return c;
+		}
+		virtual std::streamsize xsputn(const char* s, std::streamsize n)
+		{
+			size_t end = start + position + (size_t)n;
+			if (target.size() < end) target.resize(end);
+			std::copy(s, s + n, target.begin() + (start + position));
+			position += (size_t)n;
+			return n;
+		}
+		//Seeking back is used for writing counts after the data, like the stl triangle count
+		virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+		{
+			off_type base = dir == std::ios_base::beg ? 0 : dir == std::ios_base::cur ? (off_type)position
+				: (off_type)(target.size() - start);
+			if (!(which & std::ios_base::out) || base + off < 0) return pos_type(off_type(-1));
+			position = (size_t)(base + off);
+			return pos_type(base + off);
+		}
+		virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which)
+		{
+			return seekoff(off_type(pos), std::ios_base::beg, which);
+		}
+	};
+
+	/*
+	Stream buffer writing into a caller provided memory block.
+	Writing past the end fails, and the stream gets badbit set.
+	Use it with std::ostream, written() gives the number of used bytes.
+	*/
+	class FixedOutputBuffer : public std::streambuf {
+	public:
+		FixedOutputBuffer(char* data, size_t capacity)
+		{
+			setp(data, data + capacity);
+			begin = data;
+			high = data;
+		}
+
+		//Bytes written so far (the highest position reached)
+		size_t written() const
+		{
+			return (size_t)((pptr() > high ? pptr() : high) - begin);
+		}
+
+	protected:
+		char* begin;
+		char* high;
+
+		virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+		{
+			if (pptr() > high) high = pptr();
+			char* target = (dir == std::ios_base::beg ? begin : dir == std::ios_base::cur ? pptr() : epptr()) + off;
+			if (!(which & std::ios_base::out) || target < begin || target > epptr()) return pos_type(off_type(-1));
+			//Resetting the put area instead of pbump, which only takes an int
+			setp(target, epptr());
+			return pos_type(target - begin);
+		}
+		virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which)
+		{
+			return seekoff(off_type(pos), std::ios_base::beg, which);
+		}
+	};
+}
+#endif
@@ -0,0 +1,56 @@
+#include "MemoryTracker.h"
+using namespace FormatConverter;
+
+//Starts with nothing held and no stage
+FormatConverter::MemoryTracker::MemoryTracker() : current_bytes(0), peak_bytes(0)
+{
+}
+
+//Adds to the held bytes and raises the peak if needed
+void FormatConverter::MemoryTracker::allocate(size_t bytes)
+{
+	size_t now = current_bytes += bytes;
+	size_t peak = peak_bytes.load();
+	while (now > peak && !peak_bytes.compare_exchange_weak(peak, now));
+}
+
+//Removes from the held bytes
+void FormatConverter::MemoryTracker::release(size_t bytes)
+{
+	current_bytes -= bytes;
+}
+
+//Registers a growing or shrinking buffer
+void FormatConverter::MemoryTracker::resize(size_t old_bytes, size_t new_bytes)
+{
+	if (new_bytes > old_bytes) allocate(new_bytes - old_bytes);
+	else release(old_bytes - new_bytes);
+}
+
+//Bytes held at the moment
+size_t FormatConverter::MemoryTracker::current() const
+{
+	return current_bytes;
+}
+
+//Peak of the current stage
+size_t FormatConverter::MemoryTracker::peak() const
+{
+	return peak_bytes;
+}
+
+//Saves the peak of the previous stage, and restarts the peak from the current value
+void FormatConverter::MemoryTracker::begin_stage(const std::string & name)
+{
+	if (!stage.empty()) stages.push_back(StageMemory{ stage, peak_bytes });
+	stage = name;
+	peak_bytes = current_bytes.load();
+}
+
+//Closes the last stage
+const std::vector<StageMemory>& FormatConverter::MemoryTracker::finish()
+{
+	if (!stage.empty()) stages.push_back(StageMemory{ stage, peak_bytes });
+	stage.clear();
+	return stages;
+}
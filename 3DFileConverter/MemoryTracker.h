@@ -0,0 +1,49 @@
+#ifndef UNIQUE_MemoryTracker
+#define UNIQUE_MemoryTracker
+#include <atomic>
+#include <string>
+#include <vector>
+namespace FormatConverter {
+	//Peak memory of a conversion stage
+	struct StageMemory
+	{
+		std::string stage;
+		size_t peak_bytes;
+	};
+
+	/*
+	Counts the bytes held by the tracked buffers, and the peak of it per stage.
+	Thread safe, the buffers report their own allocations and releases.
+	*/
+	class MemoryTracker {
+	public:
+		MemoryTracker();
+
+		//Registers bytes held by a buffer
+		void allocate(size_t bytes);
+		//Registers bytes given back by a buffer
+		void release(size_t bytes);
+		//Registers the change of a buffer from old_bytes to new_bytes
+		void resize(size_t old_bytes, size_t new_bytes);
+
+		//Bytes held at the moment
+		size_t current() const;
+		//Highest value of current() since the start of the stage
+		size_t peak() const;
+
+		/*
+		Closes the current stage with its peak, and starts a new one.
+		The peak of the new stage starts from the bytes held at the moment.
+		*/
+		void begin_stage(const std::string& name);
+		//Closes the current stage, returns the peaks of all closed stages
+		const std::vector<StageMemory>& finish();
+
+	protected:
+		std::atomic<size_t> current_bytes;
+		std::atomic<size_t> peak_bytes;
+		std::string stage;
+		std::vector<StageMemory> stages;
+	};
+}
+#endif
@@ -0,0 +1,232 @@
+#include "MeshSlicer.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+using namespace FormatConverter;
+
+//A face crossing a plane, from the edge going down through the plane to the edge going up
+struct SliceSegment
+{
+	//Edges as smaller vertex * vertex count + bigger vertex, the same for the neighbouring face
+	uint64_t from_key;
+	uint64_t to_key;
+	ContourPoint from;
+	ContourPoint to;
+};
+
+//Segment index by the key of its starting edge, for chaining
+struct SegmentStart
+{
+	uint64_t key;
+	uint32_t segment;
+
+	bool operator<(const SegmentStart& other) const
+	{
+		return key < other.key;
+	}
+};
+
+//Crossing point of an edge with the plane z, a is below and b is on or above it
+//The point is always calculated from the lower vertex, so both faces of the edge get the same result
+static ContourPoint crossing(const Vertex& a, const Vertex& b, float z)
+{
+	float t = (z - a.z) / (b.z - a.z);
+	return ContourPoint{ a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+}
+
+//Stores the settings
+FormatConverter::MeshSlicer::MeshSlicer(unsigned int thread_count) : thread_count(thread_count)
+{
+}
+
+//Puts the faces into the layers they cross, then slices the layers in parallel
+std::vector<SliceLayer> FormatConverter::MeshSlicer::slice(const D3Data & data, float first_z, float layer_height, size_t layer_count)
+{
+	if (!(layer_height > 0))
+		throw std::invalid_argument("Layer height has to be positive");
+	const size_t face_count = data.faces.size();
+	const uint64_t vertex_count = data.vertices.size();
+	if (face_count > UINT32_MAX || vertex_count > UINT32_MAX)
+		throw std::length_error("Too many vertices or faces for slicing");
+
+	std::vector<SliceLayer> layers(layer_count);
+	//Planes are calculated the same way everywhere, so the comparisons agree
+	auto plane = [&](size_t i) { return (float)(first_z + (double)i * layer_height); };
+	for (size_t i = 0; i < layer_count; i++) layers[i].z = plane(i);
+	if (layer_count == 0 || face_count == 0) return layers;
+
+	//First layer with its plane above z (or layer_count if there is none)
+	auto first_above = [&](float z)
+	{
+		double guess = std::floor((z - (double)first_z) / layer_height);
+		size_t i = guess < 0 ? 0 : guess >= (double)layer_count ? layer_count : (size_t)guess;
+		while (i > 0 && plane(i - 1) > z) --i;
+		while (i < layer_count && plane(i) <= z) ++i;
+		return i;
+	};
+
+	//Layer range of each face, [first, last), and the number of faces per layer and thread
+	//The counts are stored as differences, a face adds one at its first layer and removes it after the last
+	std::vector<uint32_t> span_first(face_count), span_last(face_count);
+	const size_t threads = Parallel::thread_count(thread_count);
+	std::vector<std::vector<size_t>> counts(threads);
+	size_t ranges = Parallel::for_ranges(face_count, thread_count, [&](size_t begin, size_t end, size_t t)
+	{
+		std::vector<size_t>& count = counts[t];
+		count.assign(layer_count + 1, 0);
+		for (size_t i = begin; i < end; i++)
+		{
+			const Face& f = data.faces[i];
+			if (f.V1 < 1 || f.V2 < 1 || f.V3 < 1 || (uint64_t)f.V1 > vertex_count || (uint64_t)f.V2 > vertex_count || (uint64_t)f.V3 > vertex_count)
+				throw InvalidFormatException(("Out of range index in face " + std::to_string(i + 1)).c_str());
+			float z1 = data.vertices[f.V1 - 1].z, z2 = data.vertices[f.V2 - 1].z, z3 = data.vertices[f.V3 - 1].z;
+			//A face crosses the planes with lowest z < plane <= highest z
+			size_t first = first_above(std::min(z1, std::min(z2, z3)));
+			size_t last = first_above(std::max(z1, std::max(z2, z3)));
+			span_first[i] = (uint32_t)first;
+			span_last[i] = (uint32_t)last;
+			if (first < last)
+			{
+				++count[first];
+				--count[last];
+			}
+		}
+		//Differences into counts
+		size_t running = 0;
+		for (size_t l = 0; l < layer_count; l++)
+		{
+			running += count[l];
+			count[l] = running;
+		}
+	});
+
+	//Offsets of every layer and thread, the faces keep their order inside a layer
+	std::vector<size_t> layer_start(layer_count + 1, 0);
+	for (size_t l = 0; l < layer_count; l++)
+	{
+		size_t offset = layer_start[l];
+		for (size_t t = 0; t < ranges; t++)
+		{
+			size_t c = counts[t][l];
+			counts[t][l] = offset;
+			offset += c;
+		}
+		layer_start[l + 1] = offset;
+	}
+	std::vector<uint32_t> layer_faces(layer_start[layer_count]);
+	Parallel::for_ranges(face_count, thread_count, [&](size_t begin, size_t end, size_t t)
+	{
+		std::vector<size_t>& offset = counts[t];
+		for (size_t i = begin; i < end; i++)
+			for (size_t l = span_first[i]; l < span_last[i]; l++)
+				layer_faces[offset[l]++] = (uint32_t)i;
+	});
+	counts.clear();
+
+	//Scratch vectors of the threads, reused between layers
+	std::vector<std::vector<SliceSegment>> segment_buffers(threads);
+	std::vector<std::vector<SegmentStart>> start_buffers(threads);
+	std::vector<std::vector<char>> state_buffers(threads);
+	Parallel::for_each(layer_count, thread_count, [&](size_t l, size_t t)
+	{
+		const float z = layers[l].z;
+		std::vector<SliceSegment>& segments = segment_buffers[t];
+		segments.clear();
+		for (size_t k = layer_start[l]; k < layer_start[l + 1]; k++)
+		{
+			const Face& f = data.faces[layer_faces[k]];
+			uint64_t v[3] = { (uint64_t)f.V1 - 1, (uint64_t)f.V2 - 1, (uint64_t)f.V3 - 1 };
+			SliceSegment s;
+			//Going around the face, one edge goes up through the plane and one goes down
+			for (int e = 0; e < 3; e++)
+			{
+				uint64_t a = v[e], b = v[(e + 1) % 3];
+				const Vertex& va = data.vertices[a];
+				const Vertex& vb = data.vertices[b];
+				bool a_above = va.z >= z, b_above = vb.z >= z;
+				if (a_above == b_above) continue;
+				uint64_t key = a < b ? a * vertex_count + b : b * vertex_count + a;
+				if (b_above)
+				{
+					s.to_key = key;
+					s.to = crossing(va, vb, z);
+				}
+				else
+				{
+					s.from_key = key;
+					s.from = crossing(vb, va, z);
+				}
+			}
+			segments.push_back(s);
+		}
+
+		//Chaining: the next segment starts at the edge where the current one ends
+		std::vector<SegmentStart>& starts = start_buffers[t];
+		starts.resize(segments.size());
+		for (size_t i = 0; i < segments.size(); i++) starts[i] = SegmentStart{ segments[i].from_key, (uint32_t)i };
+		std::sort(starts.begin(), starts.end());
+		//0 unused, 1 has a previous segment, 2 used in a contour
+		std::vector<char>& state = state_buffers[t];
+		state.assign(segments.size(), 0);
+		auto next_of = [&](size_t i) -> size_t
+		{
+			SegmentStart key = SegmentStart{ segments[i].to_key, 0 };
+			auto it = std::lower_bound(starts.begin(), starts.end(), key);
+			for (; it != starts.end() && it->key == key.key; ++it)
+				if (state[it->segment] != 2) return it->segment;
+			return segments.size();
+		};
+		for (size_t i = 0; i < segments.size(); i++)
+		{
+			size_t next = next_of(i);
+			if (next < segments.size()) state[next] = 1;
+		}
+
+		//Open chains are followed from their first segment, everything left forms loops
+		std::vector<Contour>& contours = layers[l].contours;
+		for (int pass = 0; pass < 2; pass++)
+		{
+			for (size_t i = 0; i < segments.size(); i++)
+			{
+				if (state[i] == 2 || (pass == 0 && state[i] == 1)) continue;
+				Contour contour;
+				contour.closed = false;
+				size_t current = i;
+				while (true)
+				{
+					state[current] = 2;
+					contour.points.push_back(segments[current].from);
+					size_t next = next_of(current);
+					if (next == segments.size())
+					{
+						//Back at the start, or at a hole of the mesh
+						contour.closed = segments[current].to_key == segments[i].from_key;
+						if (!contour.closed) contour.points.push_back(segments[current].to);
+						break;
+					}
+					current = next;
+				}
+				contours.push_back(std::move(contour));
+			}
+		}
+	});
+	return layers;
+}
+
+//Slices the bounding box height of the mesh
+std::vector<SliceLayer> FormatConverter::MeshSlicer::slice(const D3Data & data, float layer_height)
+{
+	if (!(layer_height > 0))
+		throw std::invalid_argument("Layer height has to be positive");
+	if (data.vertices.empty()) return std::vector<SliceLayer>();
+	float low = data.vertices[0].z, high = low;
+	for (size_t i = 1; i < data.vertices.size(); i++)
+	{
+		low = std::min(low, data.vertices[i].z);
+		high = std::max(high, data.vertices[i].z);
+	}
+	size_t layer_count = (size_t)std::floor((high - (double)low) / layer_height + 0.5);
+	return slice(data, low + layer_height / 2, layer_height, layer_count);
+}
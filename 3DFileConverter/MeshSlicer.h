@@ -0,0 +1,62 @@
+#ifndef UNIQUE_MeshSlicer
+#define UNIQUE_MeshSlicer
+#include "ConverterBase.h"
+#include <vector>
+namespace FormatConverter {
+	//A point of a contour in the plane of its layer
+	struct ContourPoint
+	{
+		float x;
+		float y;
+	};
+
+	/*
+	Outline of the mesh in a layer. For a closed, consistently oriented mesh
+	outer contours go counterclockwise and holes clockwise, seen from +Z.
+	*/
+	struct Contour
+	{
+		std::vector<ContourPoint> points;
+		//False if the chain ended at a hole of the mesh, then the last point is not joined to the first
+		bool closed;
+	};
+
+	//Intersection of the mesh with the plane z
+	struct SliceLayer
+	{
+		float z;
+		std::vector<Contour> contours;
+	};
+
+	/*
+	Intersects a mesh with a stack of planes parallel to XY, for print layers.
+	Every face is put into the layers between its lowest and highest vertex, so
+	it is tested only against the planes it crosses. The layers are then
+	processed in parallel: the segments of a layer are chained into contours
+	through the edges the neighbouring faces share.
+	Vertices lying exactly on a plane count as above it, so every crossed face
+	gives exactly one segment.
+	*/
+	class MeshSlicer {
+	public:
+		//If thread_count is 0, the number of hardware threads is used.
+		MeshSlicer(unsigned int thread_count = 0);
+
+		/*
+		Slices at z = first_z + i * layer_height for i in [0, layer_count).
+		Face indexes have to be positive, the faces have to share their vertices
+		for the contours to be chained (like after loading an obj file).
+		Throws std::invalid_argument if layer_height is not positive,
+		InvalidFormatException if a face index is out of range and
+		std::length_error if there are more than 2^32 faces or vertices.
+		*/
+		std::vector<SliceLayer> slice(const D3Data& data, float first_z, float layer_height, size_t layer_count);
+
+		//Slices the whole height of the mesh, with the planes in the middle of the layers
+		std::vector<SliceLayer> slice(const D3Data& data, float layer_height);
+
+	protected:
+		unsigned int thread_count;
+	};
+}
+#endif
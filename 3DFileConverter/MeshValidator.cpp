@@ -0,0 +1,172 @@
+#include "MeshValidator.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+using namespace FormatConverter;
+
+//An edge of a face, stored the same way for both directions
+struct FaceEdge
+{
+	uint32_t low;
+	uint32_t high;
+	uint32_t face;
+};
+
+//True if the face uses the same vertex more than once
+static bool is_degenerate(const Face& f)
+{
+	return f.V1 == f.V2 || f.V2 == f.V3 || f.V1 == f.V3;
+}
+
+//True if the face goes from vertex a to vertex b, the vertexes are zero based
+static bool goes_from(const Face& f, uint32_t a, uint32_t b)
+{
+	uint32_t v[3] = { (uint32_t)(f.V1 - 1), (uint32_t)(f.V2 - 1), (uint32_t)(f.V3 - 1) };
+	for (int k = 0; k < 3; k++)
+		if (v[k] == a && v[(k + 1) % 3] == b) return true;
+	return false;
+}
+
+//Finds the root of a face with path halving, safe to call from multiple threads
+static uint32_t find_root(std::vector<std::atomic<uint32_t>>& parent, uint32_t i)
+{
+	for (;;)
+	{
+		uint32_t p = parent[i].load();
+		if (p == i) return i;
+		uint32_t g = parent[p].load();
+		//Parents only move to smaller indexes, so skipping one is always valid
+		if (p != g) parent[i].compare_exchange_weak(p, g);
+		i = g;
+	}
+}
+
+//Joins the groups of two faces, the bigger root is linked under the smaller one
+static void unite(std::vector<std::atomic<uint32_t>>& parent, uint32_t a, uint32_t b)
+{
+	for (;;)
+	{
+		a = find_root(parent, a);
+		b = find_root(parent, b);
+		if (a == b) return;
+		if (a < b) std::swap(a, b);
+		//Fails if another thread linked a in the meantime, then the roots are searched again
+		uint32_t expected = a;
+		if (parent[a].compare_exchange_strong(expected, b)) return;
+	}
+}
+
+//Stores the settings
+FormatConverter::MeshValidator::MeshValidator(unsigned int thread_count) : thread_count(thread_count)
+{
+}
+
+//Collects and sorts the edges, then counts the faces of each edge
+ValidationReport FormatConverter::MeshValidator::validate(const D3Data & data)
+{
+	const size_t face_count = data.faces.size();
+	const uint64_t vertex_count = data.vertices.size();
+	if (face_count > UINT32_MAX || vertex_count > UINT32_MAX)
+		throw std::length_error("Too many vertices or faces for validation");
+	ValidationReport report = ValidationReport();
+
+	//Degenerate faces are counted first and left out, so the keys only need the bits of the vertex pairs
+	std::vector<size_t> offsets(Parallel::thread_count(thread_count) + 1, 0);
+	size_t ranges = Parallel::for_ranges(face_count, thread_count, [&](size_t begin, size_t end, size_t t)
+	{
+		size_t count = 0;
+		for (size_t i = begin; i < end; i++)
+			if (is_degenerate(data.faces[i])) ++count;
+		offsets[t + 1] = count;
+	});
+	for (size_t t = 0; t < ranges; t++)
+	{
+		report.degenerate_faces += offsets[t + 1];
+		//Start of the edges of the range, the ranges are the same in the next call
+		offsets[t + 1] = offsets[t] + 3 * (face_count * (t + 1) / ranges - face_count * t / ranges) - 3 * offsets[t + 1];
+	}
+
+	//Three edges per face, from the smaller vertex to the bigger one
+	std::vector<FaceEdge> edges(3 * (face_count - report.degenerate_faces));
+	Parallel::for_ranges(face_count, thread_count, [&](size_t begin, size_t end, size_t t)
+	{
+		size_t next = offsets[t];
+		for (size_t i = begin; i < end; i++)
+		{
+			const Face& f = data.faces[i];
+			if (is_degenerate(f)) continue;
+			uint32_t v[3] = { (uint32_t)(f.V1 - 1), (uint32_t)(f.V2 - 1), (uint32_t)(f.V3 - 1) };
+			for (int k = 0; k < 3; k++)
+			{
+				uint32_t a = v[k], b = v[(k + 1) % 3];
+				FaceEdge& e = edges[next++];
+				e.low = std::min(a, b);
+				e.high = std::max(a, b);
+				e.face = (uint32_t)i;
+			}
+		}
+	});
+	auto key = [vertex_count](const FaceEdge& e) { return e.low * vertex_count + e.high; };
+	Parallel::radix_sort(edges, key, Parallel::bit_width(vertex_count * vertex_count), thread_count);
+	const size_t used = edges.size();
+
+	//Counting the faces of each edge and joining them into components, every thread takes whole runs of the same key
+	std::vector<std::atomic<uint32_t>> parent(face_count);
+	Parallel::for_ranges(face_count, thread_count, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t i = begin; i < end; i++) parent[i].store((uint32_t)i);
+	});
+	std::vector<ValidationReport> partial(Parallel::thread_count(thread_count), ValidationReport());
+	Parallel::for_ranges(used, thread_count, [&](size_t begin, size_t end, size_t t)
+	{
+		while (begin > 0 && begin < used && key(edges[begin]) == key(edges[begin - 1])) ++begin;
+		while (end > 0 && end < used && key(edges[end]) == key(edges[end - 1])) ++end;
+		ValidationReport& r = partial[t];
+		size_t i = begin;
+		while (i < end)
+		{
+			size_t first = i;
+			while (i < end && key(edges[i]) == key(edges[first])) ++i;
+			size_t count = i - first;
+			r.edges++;
+			if (count == 1) r.boundary_edges++;
+			else if (count > 2) r.non_manifold_edges++;
+			//Neighbouring faces have to go through their shared edge in opposite directions
+			else if (goes_from(data.faces[edges[first].face], edges[first].low, edges[first].high)
+				== goes_from(data.faces[edges[first + 1].face], edges[first].low, edges[first].high)) r.inconsistent_edges++;
+			for (size_t j = first + 1; j < i; j++) unite(parent, edges[first].face, edges[j].face);
+		}
+	});
+	for (size_t t = 0; t < partial.size(); t++)
+	{
+		report.edges += partial[t].edges;
+		report.boundary_edges += partial[t].boundary_edges;
+		report.non_manifold_edges += partial[t].non_manifold_edges;
+		report.inconsistent_edges += partial[t].inconsistent_edges;
+	}
+
+	//Every root is a component
+	std::vector<size_t> roots(Parallel::thread_count(thread_count), 0);
+	Parallel::for_ranges(face_count, thread_count, [&](size_t begin, size_t end, size_t t)
+	{
+		for (size_t i = begin; i < end; i++)
+			if (parent[i].load() == i) roots[t]++;
+	});
+	for (size_t t = 0; t < roots.size(); t++) report.components += roots[t];
+	//Degenerate faces have no edges, they are not counted as separate components
+	report.components -= report.degenerate_faces;
+	return report;
+}
+
+//Only returns the volume of closed, consistently oriented meshes
+float FormatConverter::MeshValidator::checked_volume(D3Data & data)
+{
+	ValidationReport report = validate(data);
+	if (!report.watertight())
+		throw InvalidFormatException(("Mesh is not watertight, no volume. Boundary edges: "
+			+ std::to_string(report.boundary_edges) + ", non-manifold edges: " + std::to_string(report.non_manifold_edges)
+			+ ", inconsistent edges: " + std::to_string(report.inconsistent_edges)).c_str());
+	return Utils::calculate_volume(data);
+}
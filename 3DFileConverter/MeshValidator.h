@@ -0,0 +1,57 @@
+#ifndef UNIQUE_MeshValidator
+#define UNIQUE_MeshValidator
+#include "ConverterBase.h"
+namespace FormatConverter {
+	//Result of a mesh validation
+	struct ValidationReport
+	{
+		//Number of distinct edges
+		size_t edges;
+		//Edges used by only one face, the mesh has a hole there
+		size_t boundary_edges;
+		//Edges used by more than two faces
+		size_t non_manifold_edges;
+		//Edges where the two faces go in the same direction, so one of them is flipped
+		size_t inconsistent_edges;
+		//Faces using the same vertex more than once, they are left out of the edges
+		size_t degenerate_faces;
+		//Groups of faces connected through edges
+		size_t components;
+
+		//True if the volume of the mesh is meaningful
+		bool watertight() const
+		{
+			return boundary_edges == 0 && non_manifold_edges == 0 && inconsistent_edges == 0;
+		}
+	};
+
+	/*
+	Checks whether a mesh is closed and consistently oriented.
+	Degenerate faces are left out, the edges of the other faces are collected
+	with a key built from their two vertices and sorted with a parallel radix sort.
+	Then the faces of each edge are counted and joined into components with a
+	lock-free union-find, both in parallel.
+	*/
+	class MeshValidator {
+	public:
+		//If thread_count is 0, the number of hardware threads is used.
+		MeshValidator(unsigned int thread_count = 0);
+
+		/*
+		Validates the mesh. Face indexes have to be positive.
+		Throws std::length_error if there are more than 2^32 faces or vertices.
+		*/
+		ValidationReport validate(const D3Data& data);
+
+		/*
+		Validates the mesh and returns its volume (see Utils::calculate_volume).
+		Throws InvalidFormatException if the mesh is not watertight, because
+		the volume would be meaningless.
+		*/
+		float checked_volume(D3Data& data);
+
+	protected:
+		unsigned int thread_count;
+	};
+}
+#endif
@@ -1,4 +1,5 @@
 #include "ObjLoader.h"
+#include <cstdio>
 #include <fstream>
 using namespace FormatConverter;
 /*
@@ -9,6 +10,20 @@ D3Data FormatConverter::CheckedObjLoader::load(std::string& path)
 {
 	return load(path, true, false, false);
 }
+
+//Calls the stream load function with the default settings
+D3Data FormatConverter::CheckedObjLoader::load(std::istream& in)
+{
+	return load(in, true, false, false);
+}
+
+//Loads from a stream into a new data object
+D3Data CheckedObjLoader::load(std::istream& in, bool check_index_validity, bool fix_neg, bool basic_triangularitaion)
+{
+	D3Data data = D3Data();
+	load_into(in, data, check_index_validity, fix_neg, basic_triangularitaion);
+	return data;
+}
 /*
 Loads the obj file into the D3Data middle format. Checks for file validity. If the
 obj specifications are not followed, throws InvalidFormatException. Index validity
@@ -21,227 +36,456 @@ parsed.
 */
 D3Data CheckedObjLoader::load(std::string& path, bool check_index_validity, bool fix_neg, bool basic_triangularitaion)
 {
-	/*
-	Creating data file and opening file on given path.
-	*/
 	D3Data data = D3Data();
+	load_into(path, data, check_index_validity, fix_neg, basic_triangularitaion);
+	return data;
+}
+
+//Loads into an existing data object, its reserved memory is reused
+void CheckedObjLoader::load_into(std::string& path, D3Data& data, bool check_index_validity, bool fix_neg, bool basic_triangularitaion)
+{
+	//Opening file on given path.
 	std::ifstream objfile(path);
-	std::string line;
 	if (!objfile.is_open())
 		throw FileException();
-	else
+	//The buffer of the file stream, its exact size depends on the library
+	if (memory_tracker) memory_tracker->allocate(BUFSIZ);
+	try
 	{
-		//Line counting for better exception information.
-		int line_num = 0;
-		try
+		load_into(objfile, data, check_index_validity, fix_neg, basic_triangularitaion);
+	}
+	catch (...)
+	{
+		if (memory_tracker) memory_tracker->release(BUFSIZ);
+		throw;
+	}
+	if (memory_tracker) memory_tracker->release(BUFSIZ);
+	objfile.close();
+}
+
+//Loads from the stream into an existing data object
+void CheckedObjLoader::load_into(std::istream& objfile, D3Data& data, bool check_index_validity, bool fix_neg, bool basic_triangularitaion)
+{
+	//Clearing data object, its memory is kept
+	data.Clear();
+	std::string line;
+	//Line counting for better exception information.
+	int line_num = 0;
+	//Registered bytes of the arrays and the line buffer, see track_growth
+	size_t capacities[6] = { 0, 0, 0, 0, 0, 0 };
+	if (memory_tracker)
+	{
+		memory_tracker->allocate(data.MemoryUsage());
+		capacities[0] = data.vertices.capacity() * sizeof(Vertex);
+		capacities[1] = data.normals.capacity() * sizeof(Normal);
+		capacities[2] = data.tcoords.capacity() * sizeof(Tcoord);
+		capacities[3] = data.faces.capacity() * sizeof(Face);
+		capacities[4] = data.parts.capacity() * sizeof(Part);
+	}
+	try
+	{
+		//Boolean for signalling that there was a face in the file
+		//Therefore there should not be any more vertices/normals/texcoords
+		bool n_faces = false;
+		Vertex vtemp;
+		Normal ntemp;
+		Tcoord ttemp;
+		Face ftemp;
+		//Last material given by usemtl, inherited by the following parts
+		std::string material;
+		//Face parser for the layout of the file, generic_faces is set after a mismatch
+		FaceParser face_parser = nullptr;
+		bool generic_faces = false;
+		//Indexes for string processing
+		std::string::size_type sz;
+		std::string::size_type pos;
+		while (getline(objfile, line))
 		{
-			//Boolean for signalling that there was a face in the file
-			//Therefore there should not be any more vertices/normals/texcoords
-			bool n_faces = false;
-			Vertex vtemp;
-			Normal ntemp;
-			Tcoord ttemp;
-			Face ftemp;
-			//Indexes for string processing
-			std::string::size_type sz;
-			std::string::size_type pos;
-			while (getline(objfile, line))
+			line_num += 1;
+			if ((line_num & 4095) == 0) check_deadline(deadline);
+			//Switch for first character
+			switch (line[0])
 			{
-				line_num += 1;
-				//Switch for first character
-				switch (line[0])
+				//Starting with v
+			case 'v':
+				//v type line after faces. Throwing InvalidFormatException.
+				if (n_faces) throw InvalidFormatException("Vertex/Normal/Texccord after faces");
+				switch (line[1])
 				{
-					//Starting with v
-				case 'v':
-					//v type line after faces. Throwing InvalidFormatException.
-					if (n_faces) throw InvalidFormatException("Vertex/Normal/Texccord after faces");
-					switch (line[1])
-					{
-						//Vertex case
-					case ' ':
-						//The rest has to be in the same format
-						//If not InvalidFormatException will be thrown
-						sz = pos = 2;
-						vtemp.x = std::stof(line.substr(pos), &sz);
-						pos += sz;
-						vtemp.y = std::stof(line.substr(pos), &sz);
-						pos += sz;
-						vtemp.z = std::stof(line.substr(pos), &sz);
-						pos += sz;
-						//w value is 0 by default
-						if (line.size() <= pos) vtemp.w = 0;
-						else {
-							vtemp.w = std::stof(line.substr(pos), &sz);
-							if (vtemp.w < 0 || vtemp.w > 1)
-								throw InvalidFormatException(("Invalid vertice w property. Line: " + std::to_string(line_num)).c_str());
-						}
-						data.vertices.push_back(vtemp);
-						break;
-						//Normal case - same format after that goes like at vertice case
-					case 'n':
-						sz = pos = 3;
-						ntemp.x = std::stof(line.substr(pos), &sz);
-						pos += sz;
-						ntemp.y = std::stof(line.substr(pos), &sz);
-						pos += sz;
-						ntemp.z = std::stof(line.substr(pos), &sz);
-						data.normals.push_back(ntemp);
-						break;
-						//Texcoord case
-					case 't':
-						sz = pos = 3;
-						ttemp.u = std::stof(line.substr(pos), &sz);
-						pos += sz;
-						ttemp.v = std::stof(line.substr(pos), &sz);
-						pos += sz;
-						//w value is 0 by default
-						if (line.size() <= pos) ttemp.w = 0;
-						else {
-							ttemp.w = std::stof(line.substr(pos), &sz);
-							if (ttemp.w < 0 || ttemp.w > 1)
-								throw InvalidFormatException(("Invalid texcoord w property. Line: " + std::to_string(line_num)).c_str());
-						}
-						data.tcoords.push_back(ttemp);
-						break;
-						//If there is anything else after v it is an invalid line
-						//Throwing InvalidFormatException
-					default:
-						throw InvalidFormatException(("Invalid line. Line: " + std::to_string(line_num)).c_str());
-						break;
+					//Vertex case
+				case ' ':
+					//The rest has to be in the same format
+					//If not InvalidFormatException will be thrown
+					sz = pos = 2;
+					vtemp.x = std::stof(line.substr(pos), &sz);
+					pos += sz;
+					vtemp.y = std::stof(line.substr(pos), &sz);
+					pos += sz;
+					vtemp.z = std::stof(line.substr(pos), &sz);
+					pos += sz;
+					//w value is 0 by default
+					if (line.size() <= pos) vtemp.w = 0;
+					else {
+						vtemp.w = std::stof(line.substr(pos), &sz);
+						if (vtemp.w < 0 || vtemp.w > 1)
+							throw InvalidFormatException(("Invalid vertice w property. Line: " + std::to_string(line_num)).c_str());
 					}
+					data.vertices.push_back(vtemp);
 					break;
-					//Face case - Only works for triangles, ignores the rest of the vertices
-				case 'f':
-					//There cannot be vertices/normals/texcoords after that
-					n_faces = true;
-					//Triangularization check if set
-					if (basic_triangularitaion)
-					{
-						//If there are more than 3 data chunks, using triangularization
-						if (Utils::count_occurences(line.substr(2), ' ') > 2)
-						{
-							//Breaking out of case 'f'
-							triangulate_polygon(data, line.substr(2));
-							break;
-						}
-					}
-					sz = pos = 2;
-					ftemp.V1 = stol(line.substr(pos), &sz);
+					//Normal case - same format after that goes like at vertice case
+				case 'n':
+					sz = pos = 3;
+					ntemp.x = std::stof(line.substr(pos), &sz);
 					pos += sz;
-					//Simple vertices case
-					if (line[pos] == ' ')
-					{
-						ftemp.V2 = stol(line.substr(pos), &sz);
-						pos += sz;
-						ftemp.V3 = stol(line.substr(pos), &sz);
-						ftemp.N1 = ftemp.N2 = ftemp.N3 = ftemp.T1 = ftemp.T2 = ftemp.T3 = 0;
+					ntemp.y = std::stof(line.substr(pos), &sz);
+					pos += sz;
+					ntemp.z = std::stof(line.substr(pos), &sz);
+					data.normals.push_back(ntemp);
+					break;
+					//Texcoord case
+				case 't':
+					sz = pos = 3;
+					ttemp.u = std::stof(line.substr(pos), &sz);
+					pos += sz;
+					ttemp.v = std::stof(line.substr(pos), &sz);
+					pos += sz;
+					//w value is 0 by default
+					if (line.size() <= pos) ttemp.w = 0;
+					else {
+						ttemp.w = std::stof(line.substr(pos), &sz);
+						if (ttemp.w < 0 || ttemp.w > 1)
+							throw InvalidFormatException(("Invalid texcoord w property. Line: " + std::to_string(line_num)).c_str());
 					}
-					//Multiple information case
-					else if (line[pos] == '/')
+					data.tcoords.push_back(ttemp);
+					break;
+					//If there is anything else after v it is an invalid line
+					//Throwing InvalidFormatException
+				default:
+					throw InvalidFormatException(("Invalid line. Line: " + std::to_string(line_num)).c_str());
+					break;
+				}
+				break;
+				//Face case - Only works for triangles, ignores the rest of the vertices
+			case 'f':
+				//There cannot be vertices/normals/texcoords after that
+				n_faces = true;
+				//Triangularization check if set
+				if (basic_triangularitaion)
+				{
+					//If there are more than 3 data chunks, using triangularization
+					if (Utils::count_occurences(line.substr(2), ' ') > 2)
 					{
-						//Texcoords missing case
-						if (line[pos + 1] == '/')
-						{
-							pos += 2;
-							ftemp.N1 = stol(line.substr(pos), &sz);
-							pos += sz;
-							ftemp.V2 = stol(line.substr(pos), &sz);
-							pos += sz + 2;
-							ftemp.N2 = stol(line.substr(pos), &sz);
-							pos += sz;
-							ftemp.V3 = stol(line.substr(pos), &sz);
-							pos += sz + 2;
-							ftemp.N3 = stol(line.substr(pos), &sz);
-							ftemp.T1 = ftemp.T2 = ftemp.T3 = 0;
-						}
-						else
-						{
-							pos += 1;
-							ftemp.T1 = stol(line.substr(pos), &sz);
-							pos += sz;
-							//All three data present case
-							//If format not valid stol will throw an exception,
-							//that is caught and converted to InvalidFormatException later
-							if (line[pos] == '/') {
-								pos += 1;
-								ftemp.N1 = stol(line.substr(pos), &sz);
-								pos += sz;
-								ftemp.V2 = stol(line.substr(pos), &sz);
-								pos += sz + 1;
-								ftemp.T2 = stol(line.substr(pos), &sz);
-								pos += sz + 1;
-								ftemp.N2 = stol(line.substr(pos), &sz);
-								pos += sz;
-								ftemp.V3 = stol(line.substr(pos), &sz);
-								pos += sz + 1;
-								ftemp.T3 = stol(line.substr(pos), &sz);
-								pos += sz + 1;
-								ftemp.N3 = stol(line.substr(pos), &sz);
-							}
-							//Normals missing case
-							//If format not valid stol wil throw an exception that is handled later
-							else {
-								ftemp.V2 = stol(line.substr(pos), &sz);
-								pos += sz + 1;
-								ftemp.T2 = stol(line.substr(pos), &sz);
-								pos += sz;
-								ftemp.V3 = stol(line.substr(pos), &sz);
-								pos += sz + 1;
-								ftemp.T3 = stol(line.substr(pos), &sz);
-								ftemp.N1 = ftemp.N2 = ftemp.N3 = 0;
-							}
-						}
+						//Breaking out of case 'f'
+						triangulate_polygon(data, line.substr(2));
+						break;
 					}
-					//If after the first value the next character is neither space or / the format is invalid
-					else throw InvalidFormatException(("Invalid face format. Line: " + std::to_string(line_num)).c_str());
-					//Index validity check if set
-					if (check_index_validity) {
-						//Fixing negative indexes
-						if (ftemp.V1 < 0) ftemp.V1 += data.vertices.size() + 1;
-						if (ftemp.V2 < 0) ftemp.V2 += data.vertices.size() + 1;
-						if (ftemp.V3 < 0) ftemp.V3 += data.vertices.size() + 1;
+				}
+				//Layout specific parser, chosen at the first face
+				if (fast_face_parsing && face_parser == nullptr && !generic_faces)
+				{
+					face_parser = face_parser_for(line);
+					generic_faces = face_parser == nullptr;
+				}
+				//On the first line not matching the layout, falling back to the generic parser
+				if (face_parser == nullptr || !face_parser(line.c_str() + 2, ftemp))
+				{
+					face_parser = nullptr;
+					generic_faces = true;
+					parse_face_generic(line, ftemp, line_num);
+				}
+				//Index validity check if set
+				if (check_index_validity) {
+					//Fixing negative indexes
+					if (ftemp.V1 < 0) ftemp.V1 += data.vertices.size() + 1;
+					if (ftemp.V2 < 0) ftemp.V2 += data.vertices.size() + 1;
+					if (ftemp.V3 < 0) ftemp.V3 += data.vertices.size() + 1;
 
-						if (ftemp.N1 < 0) ftemp.N1 += data.normals.size() + 1;
-						if (ftemp.N2 < 0) ftemp.N2 += data.normals.size() + 1;
-						if (ftemp.N3 < 0) ftemp.N3 += data.normals.size() + 1;
+					if (ftemp.N1 < 0) ftemp.N1 += data.normals.size() + 1;
+					if (ftemp.N2 < 0) ftemp.N2 += data.normals.size() + 1;
+					if (ftemp.N3 < 0) ftemp.N3 += data.normals.size() + 1;
 
-						if (ftemp.T1 < 0) ftemp.T1 += data.tcoords.size() + 1;
-						if (ftemp.T2 < 0) ftemp.T2 += data.tcoords.size() + 1;
-						if (ftemp.T3 < 0) ftemp.T3 += data.tcoords.size() + 1;
+					if (ftemp.T1 < 0) ftemp.T1 += data.tcoords.size() + 1;
+					if (ftemp.T2 < 0) ftemp.T2 += data.tcoords.size() + 1;
+					if (ftemp.T3 < 0) ftemp.T3 += data.tcoords.size() + 1;
 
-						//Checking for positive out of bound
-						if (ftemp.N1 > (long)data.normals.size() || ftemp.N2 > (long)data.normals.size() || ftemp.N3 > (long)data.normals.size()
-							|| ftemp.V1 > (long)data.vertices.size() || ftemp.V2 > (long)data.vertices.size() || ftemp.V3 > (long)data.vertices.size()
-							|| ftemp.T1 > (long)data.tcoords.size() || ftemp.T2 > (long)data.tcoords.size() || ftemp.T3 > (long)data.tcoords.size())
-							throw InvalidFormatException(("Out of range index in face. Line: " + std::to_string(line_num)).c_str());
-						//Checking for negative out of bound
-						if (ftemp.N1 < 0 || ftemp.N2 < 0 || ftemp.N3 < 0
-							|| ftemp.V1 < 1 || ftemp.V2 < 1 || ftemp.V3 < 1
-							|| ftemp.T1 < 0 || ftemp.T2 < 0 || ftemp.T3 < 0)
-							throw InvalidFormatException(("Out of range index in face. Line: " + std::to_string(line_num)).c_str());
-					}
-					data.faces.push_back(ftemp);
-					break;
-					//Anything else is ignored, like comments or invalid lines with different starting characters from v or f.
-				default:
-					break;
+					//Checking for positive out of bound
+					if (ftemp.N1 > (long)data.normals.size() || ftemp.N2 > (long)data.normals.size() || ftemp.N3 > (long)data.normals.size()
+						|| ftemp.V1 > (long)data.vertices.size() || ftemp.V2 > (long)data.vertices.size() || ftemp.V3 > (long)data.vertices.size()
+						|| ftemp.T1 > (long)data.tcoords.size() || ftemp.T2 > (long)data.tcoords.size() || ftemp.T3 > (long)data.tcoords.size())
+						throw InvalidFormatException(("Out of range index in face. Line: " + std::to_string(line_num)).c_str());
+					//Checking for negative out of bound
+					if (ftemp.N1 < 0 || ftemp.N2 < 0 || ftemp.N3 < 0
+						|| ftemp.V1 < 1 || ftemp.V2 < 1 || ftemp.V3 < 1
+						|| ftemp.T1 < 0 || ftemp.T2 < 0 || ftemp.T3 < 0)
+						throw InvalidFormatException(("Out of range index in face. Line: " + std::to_string(line_num)).c_str());
+				}
+				data.faces.push_back(ftemp);
+				break;
+				//Object or group case - starts a new part over the following faces
+			case 'o':
+			case 'g':
+				if (line.size() > 1 && line[1] != ' ') break;
+				begin_part(data, line.size() > 2 ? trim_name(line.substr(2)) : std::string(), material);
+				//A new part can have its own vertices/normals/texcoords
+				n_faces = false;
+				break;
+				//Material case - stored on the part, smoothing groups (s) are still ignored
+			case 'u':
+				if (line.compare(0, 7, "usemtl ") != 0) break;
+				material = trim_name(line.substr(7));
+				if (data.parts.size() > 0 && data.parts.back().material != material)
+				{
+					//Before the first face the part gets the material, an inherited one is replaced
+					if (data.parts.back().first_face == data.faces.size())
+						data.parts.back().material = material;
+					//Inside a part the following faces become a new part with the same name
+					//The name is copied, the parts can be reallocated
+					else
+						begin_part(data, std::string(data.parts.back().name), material);
 				}
+				break;
+				//Anything else is ignored, like comments or invalid lines with different starting characters from v or f.
+			default:
+				break;
 			}
-			objfile.close();
+			if (memory_tracker) track_growth(data, line, capacities);
 		}
-		//Invalid argument or out of range exception from stof or stol meaning invalid formatting
-		catch (const std::invalid_argument&)
+	}
+	//Invalid argument or out of range exception from stof or stol meaning invalid formatting
+	catch (const std::invalid_argument&)
+	{
+		throw(InvalidFormatException(("Bad number formatting. Line: " + std::to_string(line_num)).c_str()));
+	}
+	catch (const std::out_of_range&)
+	{
+		throw(InvalidFormatException(("Bad number formatting. Line: " + std::to_string(line_num)).c_str()));
+	}
+	//Closing the part ranges
+	finish_parts(data);
+	//If negative fixing is turned on
+	if (fix_neg) fix_negative_indexes(data);
+	//The line buffer is freed, the arrays stay with the data
+	if (memory_tracker)
+	{
+		track_growth(data, line, capacities);
+		memory_tracker->release(capacities[5]);
+	}
+}
+
+//Compares the capacities with the registered ones
+void FormatConverter::CheckedObjLoader::track_growth(const D3Data & data, const std::string & line, size_t(&capacities)[6])
+{
+	size_t now[6] = { data.vertices.capacity() * sizeof(Vertex), data.normals.capacity() * sizeof(Normal),
+		data.tcoords.capacity() * sizeof(Tcoord), data.faces.capacity() * sizeof(Face),
+		data.parts.capacity() * sizeof(Part), line.capacity() };
+	for (int i = 0; i < 6; i++)
+	{
+		if (now[i] == capacities[i]) continue;
+		//The old storage is only freed after the elements were moved to the new one
+		memory_tracker->allocate(now[i]);
+		memory_tracker->release(capacities[i]);
+		capacities[i] = now[i];
+	}
+}
+
+//Sets the tracker used during loading
+void FormatConverter::CheckedObjLoader::set_memory_tracker(MemoryTracker * tracker)
+{
+	memory_tracker = tracker;
+}
+
+//Turns the layout specific face parsers on or off
+void FormatConverter::CheckedObjLoader::set_fast_face_parsing(bool enabled)
+{
+	fast_face_parsing = enabled;
+}
+
+/*
+Parses an integer index and moves p after it. Skips spaces before the number.
+Returns false if there is no number, or it has more than 9 digits.
+*/
+static inline bool parse_index(const char*& p, long& out)
+{
+	while (*p == ' ' || *p == '\t') ++p;
+	bool negative = *p == '-';
+	if (negative) ++p;
+	const char* start = p;
+	long value = 0;
+	//9 digits always fit a 32 bit long, the rest are only skipped
+	while (*p >= '0' && *p <= '9')
+	{
+		if (p - start < 9) value = value * 10 + (*p - '0');
+		++p;
+	}
+	//Longer numbers are left for the generic parser, which reports the overflow
+	if (p == start || p - start > 9) return false;
+	out = negative ? -value : value;
+	return true;
+}
+
+/*
+Parses one corner of a face in the layout given by the template parameters.
+HasT and HasN are known at compile time, so the branches on them are removed.
+*/
+template <bool HasT, bool HasN>
+static inline bool parse_corner(const char*& p, long& v, long& t, long& n)
+{
+	if (!parse_index(p, v)) return false;
+	if (HasT || HasN)
+	{
+		if (*p != '/') return false;
+		++p;
+	}
+	if (HasT)
+	{
+		if (!parse_index(p, t)) return false;
+	}
+	else t = 0;
+	if (HasN)
+	{
+		if (*p != '/') return false;
+		++p;
+		if (!parse_index(p, n)) return false;
+	}
+	else n = 0;
+	//The corner has to end here
+	return *p == ' ' || *p == '\t' || *p == '\r' || *p == '\0';
+}
+
+//Parses the first three corners of a face line, the rest is ignored like in the generic parser
+template <bool HasT, bool HasN>
+static bool parse_face(const char* p, Face& face)
+{
+	return parse_corner<HasT, HasN>(p, face.V1, face.T1, face.N1)
+		&& parse_corner<HasT, HasN>(p, face.V2, face.T2, face.N2)
+		&& parse_corner<HasT, HasN>(p, face.V3, face.T3, face.N3);
+}
+
+//Chooses the parser by the first corner of the line
+FaceParser FormatConverter::CheckedObjLoader::face_parser_for(const std::string & line)
+{
+	size_t pos = line.find_first_of("/ \t\r", 2);
+	//v layout
+	if (pos == std::string::npos || line[pos] != '/') return &parse_face<false, false>;
+	//v//n layout
+	if (line[pos + 1] == '/') return &parse_face<false, true>;
+	pos = line.find_first_of("/ \t\r", pos + 1);
+	//v/t/n or v/t layout
+	if (pos != std::string::npos && line[pos] == '/') return &parse_face<true, true>;
+	return &parse_face<true, false>;
+}
+
+/*
+Parses a face line of any layout, inspecting the characters after each value.
+Throws invalid_argument and out_of_range from stol, and InvalidFormatException.
+*/
+void FormatConverter::CheckedObjLoader::parse_face_generic(const std::string & line, Face & ftemp, int line_num)
+{
+	std::string::size_type sz;
+	std::string::size_type pos;
+	sz = pos = 2;
+	ftemp.V1 = stol(line.substr(pos), &sz);
+	pos += sz;
+	//Simple vertices case
+	if (line[pos] == ' ')
+	{
+		ftemp.V2 = stol(line.substr(pos), &sz);
+		pos += sz;
+		ftemp.V3 = stol(line.substr(pos), &sz);
+		ftemp.N1 = ftemp.N2 = ftemp.N3 = ftemp.T1 = ftemp.T2 = ftemp.T3 = 0;
+	}
+	//Multiple information case
+	else if (line[pos] == '/')
+	{
+		//Texcoords missing case
+		if (line[pos + 1] == '/')
 		{
-			throw(InvalidFormatException(("Bad number formatting. Line: " + std::to_string(line_num)).c_str()));
+			pos += 2;
+			ftemp.N1 = stol(line.substr(pos), &sz);
+			pos += sz;
+			ftemp.V2 = stol(line.substr(pos), &sz);
+			pos += sz + 2;
+			ftemp.N2 = stol(line.substr(pos), &sz);
+			pos += sz;
+			ftemp.V3 = stol(line.substr(pos), &sz);
+			pos += sz + 2;
+			ftemp.N3 = stol(line.substr(pos), &sz);
+			ftemp.T1 = ftemp.T2 = ftemp.T3 = 0;
 		}
-		catch (const std::out_of_range&)
+		else
 		{
-			throw(InvalidFormatException(("Bad number formatting. Line: " + std::to_string(line_num)).c_str()));
+			pos += 1;
+			ftemp.T1 = stol(line.substr(pos), &sz);
+			pos += sz;
+			//All three data present case
+			//If format not valid stol will throw an exception,
+			//that is caught and converted to InvalidFormatException later
+			if (line[pos] == '/') {
+				pos += 1;
+				ftemp.N1 = stol(line.substr(pos), &sz);
+				pos += sz;
+				ftemp.V2 = stol(line.substr(pos), &sz);
+				pos += sz + 1;
+				ftemp.T2 = stol(line.substr(pos), &sz);
+				pos += sz + 1;
+				ftemp.N2 = stol(line.substr(pos), &sz);
+				pos += sz;
+				ftemp.V3 = stol(line.substr(pos), &sz);
+				pos += sz + 1;
+				ftemp.T3 = stol(line.substr(pos), &sz);
+				pos += sz + 1;
+				ftemp.N3 = stol(line.substr(pos), &sz);
+			}
+			//Normals missing case
+			//If format not valid stol wil throw an exception that is handled later
+			else {
+				ftemp.V2 = stol(line.substr(pos), &sz);
+				pos += sz + 1;
+				ftemp.T2 = stol(line.substr(pos), &sz);
+				pos += sz;
+				ftemp.V3 = stol(line.substr(pos), &sz);
+				pos += sz + 1;
+				ftemp.T3 = stol(line.substr(pos), &sz);
+				ftemp.N1 = ftemp.N2 = ftemp.N3 = 0;
+			}
 		}
 	}
-	//If negative fixing is turned on
-	if (fix_neg) fix_negative_indexes(data);
-	return data;
+	//If after the first value the next character is neither space or / the format is invalid
+	else throw InvalidFormatException(("Invalid face format. Line: " + std::to_string(line_num)).c_str());
+}
+
+//Closes the current part and starts a new one from the next face
+void FormatConverter::CheckedObjLoader::begin_part(D3Data & data, const std::string & name, const std::string & material)
+{
+	if (data.parts.size() > 0)
+		data.parts.back().face_count = data.faces.size() - data.parts.back().first_face;
+	data.parts.push_back(Part{ name, material, data.faces.size(), 0 });
+}
+
+//Closes the last part, adds the faces before the first part and removes the empty parts
+void FormatConverter::CheckedObjLoader::finish_parts(D3Data & data)
+{
+	//No object/group information, the data stays a single mesh
+	if (data.parts.size() == 0) return;
+	data.parts.back().face_count = data.faces.size() - data.parts.back().first_face;
+	if (data.parts[0].first_face > 0)
+		data.parts.insert(data.parts.begin(), Part{ "default", "", 0, data.parts[0].first_face });
+	//Like an o line directly followed by a g line
+	std::vector<Part> nonempty;
+	nonempty.reserve(data.parts.size());
+	for (size_t i = 0; i < data.parts.size(); i++)
+	{
+		if (data.parts[i].face_count > 0) nonempty.push_back(data.parts[i]);
+	}
+	data.parts.swap(nonempty);
+}
+
+//Removes whitespace from the end of the name, like a carriage return
+std::string FormatConverter::CheckedObjLoader::trim_name(const std::string & name)
+{
+	size_t end = name.find_last_not_of(" \t\r\n");
+	if (end == std::string::npos) return std::string();
+	return name.substr(0, end + 1);
 }
 
 /*
@@ -296,18 +540,18 @@ void FormatConverter::CheckedObjLoader::triangulate_polygon(D3Data & data, std::
 //Only works with data chunks in string, the f and space have to be removed from the front
 std::vector<VertexData> FormatConverter::CheckedObjLoader::tokenize_obj_face_line(std::string & line)
 {
-	//Splitting by spaces
+	//Splitting by spaces, repeated and trailing spaces give no chunks like in the face parsers
 	std::vector<std::string> chunks;
 	size_t pos = 0;
 	size_t nextpos = line.find(' ');
 	while (nextpos != std::string::npos)
 	{
-		chunks.push_back(line.substr(pos, nextpos - pos));
+		if (nextpos > pos) chunks.push_back(line.substr(pos, nextpos - pos));
 		pos = nextpos + 1;
 		nextpos = line.find(' ', pos);
 	}
 	//Adding the last part
-	chunks.push_back(line.substr(pos, line.size() - pos));
+	if (pos < line.size()) chunks.push_back(line.substr(pos, line.size() - pos));
 
 	//Parsing into vertexData
 	std::vector<VertexData> vdata;
@@ -1,7 +1,14 @@
 #ifndef UNIQUE_ObjLoader
 #define UNIQUE_ObjLoader
 #include "ConverterBase.h"
+#include "MemoryTracker.h"
 namespace FormatConverter {
+	/*
+	Parses the data chunks of a face line (without the f and space) into face.
+	Returns false if the line does not match the layout of the parser.
+	*/
+	typedef bool(*FaceParser)(const char* chunks, Face& face);
+
 	class CheckedObjLoader : public Loader {
 	public:
 		/*
@@ -13,6 +20,12 @@ namespace FormatConverter {
 		*/
 		virtual D3Data load(std::string& path);
 
+		//Same as above, but loads from a stream
+		virtual D3Data load(std::istream& in);
+
+		//Loading from memory, see Loader
+		using Loader::load;
+
 		/*
 		Throws FileException and InvalidFormatException
 		Implementation is inline, due to performance considerations
@@ -23,7 +36,60 @@ namespace FormatConverter {
 		D3Data load(std::string& path, bool check_index_validity, bool fix_neg,
 			bool basic_triangularitaion = false);
 
+		/*
+		Same as load, but the data is loaded into the given object. Its arrays are
+		cleared, but their reserved memory is kept, so reusing the same object
+		for many files avoids reallocations.
+		*/
+		void load_into(std::string& path, D3Data& data, bool check_index_validity = true,
+			bool fix_neg = false, bool basic_triangularitaion = false);
+
+		//Stream versions of the functions above, the path versions call these
+		D3Data load(std::istream& in, bool check_index_validity, bool fix_neg,
+			bool basic_triangularitaion = false);
+		void load_into(std::istream& in, D3Data& data, bool check_index_validity = true,
+			bool fix_neg = false, bool basic_triangularitaion = false);
+
+		/*
+		Face lines are parsed by a parser specialized for the layout of the first face
+		(v, v/t, v//n or v/t/n), until a line does not match, then by the generic parser.
+		Turned on by default, turning it off is only useful for comparison.
+		*/
+		void set_fast_face_parsing(bool enabled);
+
+		/*
+		If a tracker is given, loading registers the arrays of the data object, the line
+		buffer and the file buffer in it, every time they grow. A growing array holds its old
+		and new storage at the same time, this is registered too, so the peak of the tracker
+		includes it. The arrays stay registered after loading, as the data keeps them.
+		nullptr turns tracking off, this is the default.
+		*/
+		void set_memory_tracker(MemoryTracker* tracker);
+
 	protected:
+		bool fast_face_parsing = true;
+		MemoryTracker* memory_tracker = nullptr;
+
+		//Registers the storage growth of the arrays since the last call, capacities holds the last sizes in bytes
+		void track_growth(const D3Data& data, const std::string& line, size_t(&capacities)[6]);
+
+		//Returns the specialized parser for the layout of the given face line, nullptr if unknown
+		static FaceParser face_parser_for(const std::string& line);
+
+		/*
+		Parses a face line of any layout into ftemp.
+		Throws invalid_argument and out_of_range exceptions and InvalidFormatException
+		*/
+		void parse_face_generic(const std::string& line, Face& ftemp, int line_num);
+
+		//Closes the current part of the data and starts a new one with the given name
+		void begin_part(D3Data& data, const std::string& name, const std::string& material);
+
+		//Closes the last part after loading, faces before the first o/g line get a "default" part
+		void finish_parts(D3Data& data);
+
+		//Trims trailing whitespace from an object/group/material name
+		std::string trim_name(const std::string& name);
 
 		//Swaps negative indexes accordingly
 		void fix_negative_indexes(D3Data& data);
@@ -0,0 +1,120 @@
+#include "ObjWriter.h"
+#include "Parallel.h"
+#include "TextFormat.h"
+#include <cstring>
+#include <fstream>
+using namespace FormatConverter;
+
+//Stores the settings
+FormatConverter::ObjWriter::ObjWriter(unsigned int thread_count) : thread_count(thread_count)
+{
+}
+
+//Opens the file and writes into it
+bool FormatConverter::ObjWriter::write(std::string & path, D3Data & data)
+{
+	//Binary mode, so the line endings are not converted
+	std::ofstream outfile(path, std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!outfile.is_open())
+		throw FileException();
+	write(outfile, data);
+	outfile.close();
+	return true;
+}
+
+//Writes a keyword and up to four floats as a line, w is only written if it is not 0
+static void append_line(std::string& buffer, const char* keyword, size_t keyword_length,
+	const float* values, int count)
+{
+	char line[4 * TextFormat::max_length + 8];
+	memcpy(line, keyword, keyword_length);
+	size_t n = keyword_length;
+	for (int i = 0; i < count; i++)
+	{
+		line[n++] = ' ';
+		n += TextFormat::float_to_chars(values[i], line + n);
+	}
+	line[n++] = '\n';
+	buffer.append(line, n);
+}
+
+//Writes one corner of a face in the layout given by the present indexes
+static size_t write_corner(char* out, long v, long t, long n)
+{
+	size_t len = 0;
+	out[len++] = ' ';
+	len += TextFormat::int_to_chars(v, out + len);
+	if (t != 0 || n != 0) out[len++] = '/';
+	if (t != 0) len += TextFormat::int_to_chars(t, out + len);
+	if (n != 0)
+	{
+		out[len++] = '/';
+		len += TextFormat::int_to_chars(n, out + len);
+	}
+	return len;
+}
+
+//Writes the sections one after the other, each formatted in parallel
+bool FormatConverter::ObjWriter::write(std::ostream & out, D3Data & data)
+{
+	const char header[] = "# FormatConverter obj file\n";
+	out.write(header, sizeof(header) - 1);
+
+	Parallel::write_ordered(out, data.vertices.size(), chunk_size, thread_count,
+		[&](size_t begin, size_t end, std::string& buffer)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const Vertex& v = data.vertices[i];
+			float values[4] = { v.x, v.y, v.z, v.w };
+			append_line(buffer, "v", 1, values, v.w != 0 ? 4 : 3);
+		}
+	});
+	Parallel::write_ordered(out, data.tcoords.size(), chunk_size, thread_count,
+		[&](size_t begin, size_t end, std::string& buffer)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const Tcoord& t = data.tcoords[i];
+			float values[3] = { t.u, t.v, t.w };
+			append_line(buffer, "vt", 2, values, t.w != 0 ? 3 : 2);
+		}
+	});
+	Parallel::write_ordered(out, data.normals.size(), chunk_size, thread_count,
+		[&](size_t begin, size_t end, std::string& buffer)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const Normal& n = data.normals[i];
+			float values[3] = { n.x, n.y, n.z };
+			append_line(buffer, "vn", 2, values, 3);
+		}
+	});
+
+	Parallel::write_ordered(out, data.faces.size(), chunk_size, thread_count,
+		[&](size_t begin, size_t end, std::string& buffer)
+	{
+		//First part starting inside the range, the parts are ordered by their first face
+		size_t part = 0;
+		while (part < data.parts.size() && data.parts[part].first_face < begin) ++part;
+		char line[3 * (3 * TextFormat::max_length + 3) + 4];
+		for (size_t i = begin; i < end; i++)
+		{
+			if (part < data.parts.size() && data.parts[part].first_face == i)
+			{
+				buffer += "o " + data.parts[part].name + "\n";
+				if (!data.parts[part].material.empty()) buffer += "usemtl " + data.parts[part].material + "\n";
+				++part;
+			}
+			const Face& f = data.faces[i];
+			size_t n = 0;
+			line[n++] = 'f';
+			n += write_corner(line + n, f.V1, f.T1, f.N1);
+			n += write_corner(line + n, f.V2, f.T2, f.N2);
+			n += write_corner(line + n, f.V3, f.T3, f.N3);
+			line[n++] = '\n';
+			buffer.append(line, n);
+		}
+	});
+	return true;
+}
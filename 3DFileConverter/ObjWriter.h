@@ -0,0 +1,36 @@
+#ifndef UNIQUE_ObjWriter
+#define UNIQUE_ObjWriter
+#include "ConverterBase.h"
+namespace FormatConverter {
+	/*
+	Writes wavefront obj files.
+	Numbers are formatted with TextFormat (shortest form that reads back the same),
+	in parallel by ranges of vertices and faces, and written out in order.
+	*/
+	class ObjWriter : public Writer {
+	public:
+		//If thread_count is 0, the number of hardware threads is used.
+		ObjWriter(unsigned int thread_count = 0);
+
+		/*
+		Writes v, vt, vn and f lines, the face lines use the v, v/t, v//n or v/t/n
+		layout depending on the indexes present. Parts are written as o lines,
+		with usemtl if they have a material.
+		Throws FileException if not able to open file.
+		Returns true on successful writing.
+		*/
+		virtual bool write(std::string& path, D3Data& data);
+
+		//Same as above, into a stream
+		virtual bool write(std::ostream& out, D3Data& data);
+
+		//Writing into memory, see Writer
+		using Writer::write;
+
+	protected:
+		unsigned int thread_count;
+		//Items formatted by a thread at once, see Parallel::write_ordered
+		static const size_t chunk_size = 65536;
+	};
+}
+#endif
@@ -0,0 +1,208 @@
+#ifndef UNIQUE_Parallel
+#define UNIQUE_Parallel
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+namespace FormatConverter {
+	//Helpers for running work on multiple threads
+	//Implementation is inline, because they are templates
+	class Parallel {
+	public:
+		//Number of threads to use if 0 is given, never returns 0
+		static unsigned int thread_count(unsigned int requested = 0)
+		{
+			if (requested == 0) requested = std::thread::hardware_concurrency();
+			//hardware_concurrency can return 0 if it is unknown
+			return requested == 0 ? 1 : requested;
+		}
+
+		/*
+		Calls task(i, thread_index) for every i in [0, count). The items are taken
+		one by one by the threads, so uneven items even out. The calling thread
+		works too, thread_index is less than thread_count(threads).
+		The first exception thrown by a task is rethrown after all threads finished.
+		*/
+		template <typename Task>
+		static void for_each(size_t count, unsigned int threads, Task task)
+		{
+			std::atomic<size_t> next(0);
+			run(std::min((size_t)thread_count(threads), count), [&](size_t t)
+			{
+				size_t i;
+				while ((i = next++) < count) task(i, t);
+			});
+		}
+
+		/*
+		Splits [0, count) into one continuous range per thread and calls
+		task(begin, end, thread_index). Useful when every thread has its
+		own accumulator indexed by thread_index. Returns the number of ranges.
+		*/
+		template <typename Task>
+		static size_t for_ranges(size_t count, unsigned int threads, Task task)
+		{
+			size_t n = std::max((size_t)1, std::min((size_t)thread_count(threads), count));
+			run(n, [&](size_t t)
+			{
+				task(count * t / n, count * (t + 1) / n, t);
+			});
+			return n;
+		}
+
+		/*
+		Stable parallel LSD radix sort by an unsigned integer key, 8 bits per pass.
+		key(item) must return the key, key_bits limits the passes to the bits used.
+		Every pass counts the digits per thread range, then scatters the ranges
+		to their own positions, so no locking is needed.
+		*/
+		template <typename T, typename Key>
+		static void radix_sort(std::vector<T>& items, Key key, unsigned int key_bits, unsigned int threads = 0)
+		{
+			const size_t buckets = 256;
+			std::vector<T> temp(items.size());
+			std::vector<std::vector<size_t>> counts(thread_count(threads));
+			for (unsigned int shift = 0; shift < key_bits; shift += 8)
+			{
+				size_t ranges = for_ranges(items.size(), threads, [&](size_t begin, size_t end, size_t t)
+				{
+					counts[t].assign(buckets, 0);
+					for (size_t i = begin; i < end; i++) counts[t][(key(items[i]) >> shift) & 0xFF]++;
+				});
+				//Exclusive prefix sum by digit, then by range inside a digit
+				size_t offset = 0;
+				for (size_t b = 0; b < buckets; b++)
+				{
+					for (size_t t = 0; t < ranges; t++)
+					{
+						size_t n = counts[t][b];
+						counts[t][b] = offset;
+						offset += n;
+					}
+				}
+				for_ranges(items.size(), threads, [&](size_t begin, size_t end, size_t t)
+				{
+					for (size_t i = begin; i < end; i++) temp[counts[t][(key(items[i]) >> shift) & 0xFF]++] = items[i];
+				});
+				items.swap(temp);
+			}
+		}
+
+		/*
+		Formats count items in parallel and writes the text to out in the order of the items.
+		format(begin, end, buffer) has to append the text of the items [begin, end) to buffer.
+		The items are formatted in chunks by thread_count(threads) threads kept for the whole
+		call, while the calling thread writes the finished chunks. There are two buffers per
+		formatting thread, so the next round of chunks is formatted while the previous one is
+		written, and the memory used for the text stays bounded.
+		*/
+		template <typename Format>
+		static void write_ordered(std::ostream& out, size_t count, size_t chunk, unsigned int threads, Format format)
+		{
+			const size_t chunks = (count + chunk - 1) / chunk;
+			const size_t n = std::min((size_t)thread_count(threads), chunks);
+			if (n == 0) return;
+			const size_t slots = 2 * n;
+			std::vector<std::string> buffers(slots);
+			//Chunk index held by each buffer once it is formatted
+			std::vector<size_t> formatted(slots, (size_t)-1);
+			size_t written = 0;
+			bool failed = false;
+			std::atomic<size_t> next(0);
+			std::mutex mutex;
+			std::condition_variable changed;
+			//Thread 0 is the calling thread, it writes, the others format
+			run(n + 1, [&](size_t t)
+			{
+				try
+				{
+					if (t == 0)
+					{
+						for (size_t c = 0; c < chunks; c++)
+						{
+							{
+								std::unique_lock<std::mutex> lock(mutex);
+								changed.wait(lock, [&] { return formatted[c % slots] == c || failed; });
+								if (failed) return;
+							}
+							out.write(buffers[c % slots].data(), buffers[c % slots].size());
+							std::lock_guard<std::mutex> lock(mutex);
+							written++;
+							changed.notify_all();
+						}
+						return;
+					}
+					size_t c;
+					while ((c = next++) < chunks)
+					{
+						{
+							//The buffer is free when the chunk before it in the same buffer was written
+							std::unique_lock<std::mutex> lock(mutex);
+							changed.wait(lock, [&] { return c < written + slots || failed; });
+							if (failed) return;
+						}
+						std::string& buffer = buffers[c % slots];
+						buffer.clear();
+						size_t begin = c * chunk;
+						format(begin, std::min(count, begin + chunk), buffer);
+						std::lock_guard<std::mutex> lock(mutex);
+						formatted[c % slots] = c;
+						changed.notify_all();
+					}
+				}
+				catch (...)
+				{
+					//The other threads stop waiting, the exception is rethrown by run
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						failed = true;
+					}
+					changed.notify_all();
+					throw;
+				}
+			});
+		}
+
+		//Number of bits needed to store the given value
+		static unsigned int bit_width(unsigned long long value)
+		{
+			unsigned int bits = 0;
+			while (value > 0)
+			{
+				++bits;
+				value >>= 1;
+			}
+			return bits;
+		}
+
+	protected:
+		//Runs body(thread_index) on n threads including the calling one
+		template <typename Body>
+		static void run(size_t n, Body body)
+		{
+			std::exception_ptr first_error;
+			std::mutex error_mutex;
+			auto guarded = [&](size_t t)
+			{
+				try { body(t); }
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(error_mutex);
+					if (!first_error) first_error = std::current_exception();
+				}
+			};
+			std::vector<std::thread> threads;
+			if (n > 1) threads.reserve(n - 1);
+			for (size_t t = 1; t < n; t++) threads.push_back(std::thread(guarded, t));
+			if (n > 0) guarded(0);
+			for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+			if (first_error) std::rethrow_exception(first_error);
+		}
+	};
+}
+#endif
@@ -0,0 +1,55 @@
+#include "PartWriter.h"
+#include "Parallel.h"
+#include <atomic>
+using namespace FormatConverter;
+
+//Stores the wrapped writer and the settings
+FormatConverter::PartWriter::PartWriter(Writer & writer, const std::string & extension, unsigned int thread_count)
+	: writer(writer), extension(extension), thread_count(thread_count)
+{
+}
+
+//Writes every part into a separate file in parallel
+bool FormatConverter::PartWriter::write(std::string & path, D3Data & data)
+{
+	if (data.parts.size() == 0)
+	{
+		std::string whole = path + extension;
+		return writer.write(whole, data);
+	}
+
+	std::atomic<bool> success(true);
+	const D3Data& shared = data;
+	//Index maps of each thread, reused between the parts written by it
+	unsigned int threads = Parallel::thread_count(thread_count);
+	std::vector<std::vector<long>> vertex_maps(threads), normal_maps(threads), tcoord_maps(threads);
+
+	//Parts are taken one by one by the threads, so big and small parts even out
+	Parallel::for_each(shared.parts.size(), threads, [&](size_t i, size_t t)
+	{
+		D3Data part = shared.ExtractPart(shared.parts[i], vertex_maps[t], normal_maps[t], tcoord_maps[t]);
+		std::string file = part_path(path, i, shared.parts[i]);
+		if (!writer.write(file, part)) success = false;
+	});
+
+	return success;
+}
+
+//Writes the whole mesh into the stream with the wrapped writer
+bool FormatConverter::PartWriter::write(std::ostream & out, D3Data & data)
+{
+	return writer.write(out, data);
+}
+
+//Creates path_<index>_<name><extension>, the index keeps the names unique
+std::string FormatConverter::PartWriter::part_path(const std::string & path, size_t index, const Part & part) const
+{
+	std::string name = part.name;
+	for (size_t i = 0; i < name.size(); i++)
+	{
+		char c = name[i];
+		if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '.'))
+			name[i] = '_';
+	}
+	return path + "_" + std::to_string(index) + (name.empty() ? "" : "_" + name) + extension;
+}
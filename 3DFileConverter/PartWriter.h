@@ -0,0 +1,45 @@
+#ifndef UNIQUE_PartWriter
+#define UNIQUE_PartWriter
+#include "ConverterBase.h"
+namespace FormatConverter {
+	/*
+	Writer for meshes consisting of multiple parts (o/g lines in obj).
+	Every part is compacted into its own D3Data object and written out
+	with the wrapped writer into a separate file. The parts are processed
+	concurrently by a fixed number of threads.
+	*/
+	class PartWriter : public Writer {
+	public:
+		/*
+		The wrapped writer is used from multiple threads at once, so its
+		write function must not modify the state of the writer.
+		extension is appended to the file names, for example ".stl".
+		If thread_count is 0, the number of hardware threads is used.
+		*/
+		PartWriter(Writer& writer, const std::string& extension, unsigned int thread_count = 0);
+
+		/*
+		Writes each part of the data to path_<index>_<name><extension>.
+		If the data has no parts, the whole mesh is written to path<extension>.
+		Throws the first exception thrown by the wrapped writer (FileException
+		if a file cannot be opened), after all threads have finished.
+		Returns true if every part was written successfully.
+		*/
+		virtual bool write(std::string& path, D3Data& data);
+
+		//A single stream cannot hold multiple files, the whole mesh is written with the wrapped writer
+		virtual bool write(std::ostream& out, D3Data& data);
+
+		//Writing into memory, see Writer
+		using Writer::write;
+
+		//Creates the file name of a part, replacing characters not safe in file names
+		std::string part_path(const std::string& path, size_t index, const Part& part) const;
+
+	protected:
+		Writer& writer;
+		std::string extension;
+		unsigned int thread_count;
+	};
+}
+#endif
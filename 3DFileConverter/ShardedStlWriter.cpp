@@ -0,0 +1,177 @@
+#include "ShardedStlWriter.h"
+#include "Parallel.h"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+using namespace FormatConverter;
+
+//Stores the settings, the face limit is clamped to the format limit
+FormatConverter::ShardedStlWriter::ShardedStlWriter(size_t max_faces, unsigned int grid_x,
+	unsigned int grid_y, unsigned int grid_z, unsigned int thread_count)
+	: max_faces(max_faces), grid_x(grid_x), grid_y(grid_y), grid_z(grid_z), thread_count(thread_count)
+{
+	if (this->max_faces == 0 || this->max_faces > UINT32_MAX) this->max_faces = UINT32_MAX;
+	if (this->grid_x == 0) this->grid_x = 1;
+	if (this->grid_y == 0) this->grid_y = 1;
+	if (this->grid_z == 0) this->grid_z = 1;
+	//The tile of a face is stored on 32 bits during sorting
+	cells = (size_t)this->grid_x * this->grid_y * this->grid_z;
+	if ((uint64_t)this->grid_x * this->grid_y * this->grid_z > UINT32_MAX)
+		throw std::invalid_argument("Too many tiles in the grid");
+}
+
+//Calls write with default settings
+bool FormatConverter::ShardedStlWriter::write(std::string & path, D3Data & data)
+{
+	return write(path, data, 'c');
+}
+
+//Sorts the faces into tiles, then writes the shards in parallel
+bool FormatConverter::ShardedStlWriter::write(std::string & path, D3Data & data, char n_type)
+{
+	//Caching before the threads start, CachedFaces is not thread safe
+	const std::vector<CachedFace>& cachedData = data.CachedFaces();
+	if (data.normals.size() == 0) n_type = 'c';
+
+	//Without a grid the faces are written in their original order
+	std::vector<size_t> order;
+	std::vector<size_t> tiles;
+	std::vector<size_t> tile_start;
+	if (cells > 1) sort_by_cell(data, order, tiles, tile_start);
+	else
+	{
+		tiles = { 0 };
+		tile_start = { 0, cachedData.size() };
+	}
+
+	//Splitting the tiles into shards by the face limit
+	last_shards.clear();
+	for (size_t k = 0; k < tiles.size(); k++)
+	{
+		size_t c = tiles[k];
+		for (size_t first = tile_start[k]; first < tile_start[k + 1]; first += max_faces)
+		{
+			Shard s;
+			s.cell_x = (unsigned int)(c % grid_x);
+			s.cell_y = (unsigned int)(c / grid_x % grid_y);
+			s.cell_z = (unsigned int)(c / grid_x / grid_y);
+			s.first = first;
+			s.face_count = std::min(max_faces, tile_start[k + 1] - first);
+			s.file = path + "_" + std::to_string(last_shards.size()) + ".stl";
+			last_shards.push_back(s);
+		}
+	}
+
+	Parallel::for_each(last_shards.size(), thread_count, [&](size_t i, size_t)
+	{
+		const Shard& s = last_shards[i];
+		std::ofstream outfile(s.file, std::ios::binary | std::ios::out | std::ios::trunc);
+		if (!outfile.is_open())
+			throw FileException();
+		writeHeader(outfile, (uint32_t)s.face_count);
+		if (order.empty()) writeFaces(outfile, cachedData, nullptr, s.face_count, n_type, s.first);
+		else writeFaces(outfile, cachedData, &order[s.first], s.face_count, n_type);
+	});
+
+	write_manifest(path, cachedData.size());
+	return true;
+}
+
+//Shards of the last write
+const std::vector<ShardedStlWriter::Shard>& FormatConverter::ShardedStlWriter::shards() const
+{
+	return last_shards;
+}
+
+//Radix sort by the tile of the face centroids
+void FormatConverter::ShardedStlWriter::sort_by_cell(D3Data & data, std::vector<size_t>& order, std::vector<size_t>& tiles,
+	std::vector<size_t>& tile_start)
+{
+	const std::vector<CachedFace>& faces = data.CachedFaces();
+	unsigned int threads = Parallel::thread_count(thread_count);
+
+	//Bounding box, one accumulator per thread
+	std::vector<Vertex> mins(threads), maxs(threads);
+	size_t ranges = Parallel::for_ranges(data.vertices.size(), threads, [&](size_t begin, size_t end, size_t t)
+	{
+		Vertex lo{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), 0 };
+		Vertex hi{ -lo.x, -lo.y, -lo.z, 0 };
+		for (size_t i = begin; i < end; i++)
+		{
+			const Vertex& v = data.vertices[i];
+			lo.x = std::min(lo.x, v.x); lo.y = std::min(lo.y, v.y); lo.z = std::min(lo.z, v.z);
+			hi.x = std::max(hi.x, v.x); hi.y = std::max(hi.y, v.y); hi.z = std::max(hi.z, v.z);
+		}
+		mins[t] = lo;
+		maxs[t] = hi;
+	});
+	Vertex lo = mins[0], hi = maxs[0];
+	for (size_t t = 1; t < ranges; t++)
+	{
+		lo.x = std::min(lo.x, mins[t].x); lo.y = std::min(lo.y, mins[t].y); lo.z = std::min(lo.z, mins[t].z);
+		hi.x = std::max(hi.x, maxs[t].x); hi.y = std::max(hi.y, maxs[t].y); hi.z = std::max(hi.z, maxs[t].z);
+	}
+
+	//Tile index of a coordinate, degenerate or infinite extents and nan values go into the first tile
+	auto tile = [](float value, float min, float max, unsigned int n) -> size_t
+	{
+		if (!(max > min) || !std::isfinite(min) || !std::isfinite(max) || std::isnan(value)) return 0;
+		//In double, the extent of finite floats can overflow a float
+		double position = ((double)value - min) / ((double)max - min) * n;
+		if (!(position > 0)) return 0;
+		return position < n ? (size_t)position : n - 1;
+	};
+
+	//Computing the tile of every face
+	std::vector<uint32_t> cell_of(faces.size());
+	Parallel::for_ranges(faces.size(), threads, [&](size_t begin, size_t end, size_t)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			const CachedFace& f = faces[i];
+			size_t x = tile((f.V1->x + f.V2->x + f.V3->x) / 3.f, lo.x, hi.x, grid_x);
+			size_t y = tile((f.V1->y + f.V2->y + f.V3->y) / 3.f, lo.y, hi.y, grid_y);
+			size_t z = tile((f.V1->z + f.V2->z + f.V3->z) / 3.f, lo.z, hi.z, grid_z);
+			cell_of[i] = (uint32_t)(x + grid_x * (y + grid_y * z));
+		}
+	});
+
+	//Sorting the face indexes by tile, the memory does not depend on the number of tiles
+	order.resize(faces.size());
+	for (size_t i = 0; i < order.size(); i++) order[i] = i;
+	Parallel::radix_sort(order, [&](size_t i) { return cell_of[i]; }, Parallel::bit_width(cells - 1), threads);
+
+	//Only the tiles with faces are listed
+	tiles.clear();
+	tile_start.clear();
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		if (i > 0 && cell_of[order[i]] == cell_of[order[i - 1]]) continue;
+		tiles.push_back(cell_of[order[i]]);
+		tile_start.push_back(i);
+	}
+	tile_start.push_back(order.size());
+}
+
+//Writes the manifest: header, totals, then one line per shard
+void FormatConverter::ShardedStlWriter::write_manifest(const std::string & path, size_t total_faces)
+{
+	std::ofstream manifest(path + ".manifest", std::ios::out | std::ios::trunc);
+	if (!manifest.is_open())
+		throw FileException();
+	manifest << "FormatConverter stl shards" << std::endl;
+	manifest << "grid " << grid_x << " " << grid_y << " " << grid_z << std::endl;
+	manifest << "faces " << total_faces << std::endl;
+	manifest << "shards " << last_shards.size() << std::endl;
+	//file, tile coordinates and triangle count
+	for (size_t i = 0; i < last_shards.size(); i++)
+	{
+		const Shard& s = last_shards[i];
+		//Only the file name, so the shards can be moved together with the manifest
+		size_t slash = s.file.find_last_of("/\\");
+		manifest << (slash == std::string::npos ? s.file : s.file.substr(slash + 1)) << " " << s.cell_x << " " << s.cell_y << " " << s.cell_z
+			<< " " << s.face_count << std::endl;
+	}
+	manifest.close();
+}
@@ -0,0 +1,78 @@
+#ifndef UNIQUE_ShardedStlWriter
+#define UNIQUE_ShardedStlWriter
+#include "StlWriter.h"
+namespace FormatConverter {
+	/*
+	Writes a mesh into multiple binary stl files (shards).
+	The bounding box of the mesh is divided into a grid, every triangle goes
+	into the tile containing its centroid, and tiles with more triangles than
+	the limit are split further into consecutive pieces. The shards are written
+	in parallel, and a text manifest lists them for reassembly.
+	Along an axis with infinite coordinates, and for nan centroids, faces go into the first tile.
+	*/
+	class ShardedStlWriter : public StlWriter {
+	public:
+		//Description of a written shard
+		struct Shard
+		{
+			std::string file;
+			//Grid tile of the shard
+			unsigned int cell_x;
+			unsigned int cell_y;
+			unsigned int cell_z;
+			size_t face_count;
+			//Offset into the ordered face list
+			size_t first;
+		};
+
+		/*
+		max_faces limits the triangles per shard, it cannot be more than the
+		32-bit limit of the format. grid_x/y/z is the number of tiles along the axes,
+		1x1x1 means only splitting by face count.
+		If thread_count is 0, the number of hardware threads is used.
+		Throws std::invalid_argument if the grid has more than 2^32-1 tiles.
+		*/
+		ShardedStlWriter(size_t max_faces = 16777216, unsigned int grid_x = 1,
+			unsigned int grid_y = 1, unsigned int grid_z = 1, unsigned int thread_count = 0);
+
+		//Calls write with the default 'c' n_type
+		virtual bool write(std::string& path, D3Data& data);
+
+		/*
+		Writes the shards to path_<index>.stl and the manifest to path.manifest.
+		n_type works like in StlWriter.
+		Throws FileException if a file cannot be opened.
+		Returns true on successful writing.
+		*/
+		bool write(std::string& path, D3Data& data, char n_type);
+
+		//A single stream holds a single stl, the stream versions of StlWriter are used
+		using StlWriter::write;
+
+		//Shards written by the last write call
+		const std::vector<Shard>& shards() const;
+
+	protected:
+		size_t max_faces;
+		unsigned int grid_x;
+		unsigned int grid_y;
+		unsigned int grid_z;
+		//Number of tiles, grid_x * grid_y * grid_z
+		size_t cells;
+		unsigned int thread_count;
+		std::vector<Shard> last_shards;
+
+		/*
+		Orders the faces by grid tile with a parallel radix sort.
+		Fills order with face indexes, tiles with the tiles having faces, and tile_start
+		with the first position of each of them (one more entry for the end).
+		Stable, faces keep their order inside a tile.
+		*/
+		void sort_by_cell(D3Data& data, std::vector<size_t>& order, std::vector<size_t>& tiles,
+			std::vector<size_t>& tile_start);
+
+		//Writes the list of shards so the mesh can be reassembled
+		void write_manifest(const std::string& path, size_t total_faces);
+	};
+}
+#endif
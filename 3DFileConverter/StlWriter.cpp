@@ -1,5 +1,6 @@
 #include "StlWriter.h"
-#include <fstream>
+#include <algorithm>
+#include <cstring>
 using namespace FormatConverter;
 //Calls write with default settings
 bool StlWriter::write(std::string & path, D3Data & data)
@@ -10,78 +11,97 @@ bool StlWriter::write(std::string & path, D3Data & data)
 //Writes given data object onto given path, n_type defines what normals will be written
 bool StlWriter::write(std::string& path, D3Data& data, char n_type)
 {
+	//The triangle count is stored on 32 bits, checked before truncating the file
+	if (data.faces.size() > UINT32_MAX)
+		throw InvalidFormatException("Too many triangles for a binary stl file");
 	//Throwin exception if unable to open file
 	std::ofstream outfile(path, std::ios::binary | std::ios::out | std::ios::trunc);
 	if (!outfile.is_open())
 		throw FileException();
-	else
-	{
-		//Writing binary output
-		//Header
-		char header[80]="FormatConverter stl file";
-		outfile.write(header, 80);
-
-		uint32_t num_of_triangles = data.faces.size();
-		//Forcing little endian according to the documentation
-		uint8_t bytes[4];
-		bytes[0] = (num_of_triangles) & 0xFF;
-		bytes[1] = (num_of_triangles >> 8) & 0xFF;
-		bytes[2] = (num_of_triangles >> 16) & 0xFF;
-		bytes[3] = (num_of_triangles >> 24) & 0xFF;
-		outfile.write((char*)bytes, 4);
+	write(outfile, data, n_type);
+	outfile.close();
+	return true;
+}
 
-		//Asking for cached values
-		auto cachedData = data.CachedFaces();
-		//Only using the cached values from now on
+//Calls the stream write with default settings
+bool StlWriter::write(std::ostream & out, D3Data & data)
+{
+	return write(out, data, 'c');
+}
 
-		//Loop for triangle data
-		Normal n_null{ 0, 0, 0 };
-		uint16_t attr_byte_count = 0;
-		if (data.normals.size() == 0) n_type = 'c';
-		for (size_t i = 0; i < cachedData.size(); i++)
-		{
-			//Writing normal values depending on parameter n_type
-			switch (n_type)
-			{
-			case '0':
-				writeNormal(&n_null, outfile);
-				break;
-			case 'a':
-				writeNormal(&Utils::average(*cachedData[i].N1, *cachedData[i].N2,
-					*cachedData[i].N3), outfile);
-				break;
-			default:
-				writeNormal(&Utils::calculate_normal(*cachedData[i].V1,
-					*cachedData[i].V2, *cachedData[i].V3), outfile);
-				break;
-			}
+//Writes given data object into the stream, n_type defines what normals will be written
+bool StlWriter::write(std::ostream& out, D3Data& data, char n_type)
+{
+	//The triangle count is stored on 32 bits
+	if (data.faces.size() > UINT32_MAX)
+		throw InvalidFormatException("Too many triangles for a binary stl file");
 
-			//Writing vertice values
-			writeVertex(cachedData[i].V1, outfile);
-			writeVertex(cachedData[i].V2, outfile);
-			writeVertex(cachedData[i].V3, outfile);
+	//Writing binary output
+	writeHeader(out, (uint32_t)data.faces.size());
 
-			//Writing attribute byte count - 0 by default
-			outfile.write((char*)&attr_byte_count, sizeof(uint16_t));
-		}
+	//Asking for cached values
+	const std::vector<CachedFace>& cachedData = data.CachedFaces();
+	//Only using the cached values from now on
 
-	}
-	outfile.close();
+	if (data.normals.size() == 0) n_type = 'c';
+	writeFaces(out, cachedData, nullptr, cachedData.size(), n_type);
 	return true;
 }
 
-//Writes out Vertex in binary format to given ofstream object
-void FormatConverter::StlWriter::writeVertex(const Vertex* v, std::ofstream & ofs)
+//Writes out the header and the triangle count
+void FormatConverter::StlWriter::writeHeader(std::ostream & ofs, uint32_t num_of_triangles)
 {
-	ofs.write((char*)(&(v->x)), sizeof(float));
-	ofs.write((char*)(&(v->y)), sizeof(float));
-	ofs.write((char*)(&(v->z)), sizeof(float));
+	//Header
+	char header[80] = "FormatConverter stl file";
+	ofs.write(header, 80);
+
+	//Forcing little endian according to the documentation
+	uint8_t bytes[4];
+	bytes[0] = (num_of_triangles) & 0xFF;
+	bytes[1] = (num_of_triangles >> 8) & 0xFF;
+	bytes[2] = (num_of_triangles >> 16) & 0xFF;
+	bytes[3] = (num_of_triangles >> 24) & 0xFF;
+	ofs.write((char*)bytes, 4);
+}
+
+//Writes out the triangles through a buffer, so there is only one write call per chunk
+void FormatConverter::StlWriter::writeFaces(std::ostream & ofs, const std::vector<CachedFace>& faces,
+	const size_t * order, size_t count, char n_type, size_t first)
+{
+	const size_t chunk = buffer_faces;
+	std::vector<char> buffer(chunk * face_record_size);
+	for (size_t start = 0; start < count; start += chunk)
+	{
+		check_deadline(deadline);
+		size_t n = std::min(chunk, count - start);
+		for (size_t i = 0; i < n; i++)
+		{
+			const CachedFace& face = faces[order ? order[start + i] : first + start + i];
+			packFace(&buffer[i * face_record_size], face, n_type);
+		}
+		ofs.write(&buffer[0], n * face_record_size);
+	}
 }
 
-//Writes out Normal in binary format to given ofstream object
-void FormatConverter::StlWriter::writeNormal(const Normal * n, std::ofstream & ofs)
+//Packs normal, vertices and attribute byte count of a triangle
+void FormatConverter::StlWriter::packFace(char * out, const CachedFace & face, char n_type)
 {
-	ofs.write((char*)(&(n->x)), sizeof(float));
-	ofs.write((char*)(&(n->y)), sizeof(float));
-	ofs.write((char*)(&(n->z)), sizeof(float));
+	//Writing normal values depending on parameter n_type
+	Normal n = Utils::face_normal(face, n_type);
+	memcpy(out, &n.x, sizeof(float));
+	memcpy(out + 4, &n.y, sizeof(float));
+	memcpy(out + 8, &n.z, sizeof(float));
+
+	//Writing vertice values
+	const Vertex* v[3] = { face.V1, face.V2, face.V3 };
+	for (int i = 0; i < 3; i++)
+	{
+		memcpy(out + 12 + i * 12, &v[i]->x, sizeof(float));
+		memcpy(out + 16 + i * 12, &v[i]->y, sizeof(float));
+		memcpy(out + 20 + i * 12, &v[i]->z, sizeof(float));
+	}
+
+	//Attribute byte count - 0 by default
+	uint16_t attr_byte_count = 0;
+	memcpy(out + 48, &attr_byte_count, sizeof(uint16_t));
 }
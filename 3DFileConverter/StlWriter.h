@@ -1,6 +1,8 @@
 #ifndef UNIQUE_StlWriter
 #define UNIQUE_StlWriter
 #include "ConverterBase.h"
+#include <cstdint>
+#include <fstream>
 namespace FormatConverter {
 	class StlWriter : public Writer{
 	public :
@@ -19,16 +21,37 @@ namespace FormatConverter {
 		'c' means normals will be calculated by the right hand rule - this is the default
 		'a' means normals will be averaged from data - if there are no normals,
 			the fall back is 'c'
-		Throws FileException if not able to open file
+		Throws FileException if not able to open file, and InvalidFormatException
+		if the data has more triangles than a binary stl can store (see ShardedStlWriter).
 		Returns true on successful writing.
 		*/
 		bool write(std::string& path, D3Data& data, char n_type);
 
+		//Stream versions of the functions above, the stream has to be binary
+		virtual bool write(std::ostream& out, D3Data& data);
+		bool write(std::ostream& out, D3Data& data, char n_type);
+
+		//Writing into memory, see Writer
+		using Writer::write;
+
+		//Size of one triangle in the binary format
+		static const size_t face_record_size = 50;
+		//Triangles packed into the output buffer before a write call
+		static const size_t buffer_faces = 4096;
+
 	protected:
-		//Writes out a vertice in binary format to given ofstream
-		void writeVertex(const Vertex* v, std::ofstream& ofs);
-		//Writes out a normal in binary format to given ofstream
-		void writeNormal(const Normal* n, std::ofstream& ofs);
+
+		//Writes out the header and the triangle count in little endian
+		void writeHeader(std::ostream& ofs, uint32_t num_of_triangles);
+		/*
+		Writes out count triangles in binary format to given stream, buffered.
+		If order is not null, the triangles are faces[order[0]], faces[order[1]]...,
+		otherwise faces[first], faces[first + 1]...
+		*/
+		void writeFaces(std::ostream& ofs, const std::vector<CachedFace>& faces,
+			const size_t* order, size_t count, char n_type, size_t first = 0);
+		//Packs a triangle with its normal and attribute byte count into out
+		void packFace(char* out, const CachedFace& face, char n_type);
 	};
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,160 @@
+#include "StreamingObjStlConverter.h"
+#include <cstdio>
+using namespace FormatConverter;
+
+//Parses the obj line by line, faces are packed into the output buffer right away
+size_t FormatConverter::StreamingObjStlConverter::convert(std::string & in_path, std::string & out_path,
+	char n_type, bool triangulate, MemoryTracker * tracker)
+{
+	std::ifstream objfile(in_path);
+	if (!objfile.is_open())
+		throw FileException();
+	std::ofstream outfile(out_path, std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!outfile.is_open())
+		throw FileException();
+	size_t triangles;
+	try
+	{
+		triangles = convert(objfile, outfile, n_type, triangulate, tracker);
+	}
+	catch (...)
+	{
+		//Not leaving a partial file with a wrong triangle count behind
+		outfile.close();
+		std::remove(out_path.c_str());
+		throw;
+	}
+	objfile.close();
+	outfile.close();
+	return triangles;
+}
+
+//Stream version, the output stream has to be binary and seekable
+size_t FormatConverter::StreamingObjStlConverter::convert(std::istream & objfile, std::ostream & outfile,
+	char n_type, bool triangulate, MemoryTracker * tracker)
+{
+	if (n_type != '0') n_type = 'c';
+
+	//The triangle count is written at the end, when it is known
+	writeHeader(outfile, 0);
+	std::vector<char> buffer(buffer_faces * face_record_size);
+	if (tracker) tracker->allocate(buffer.capacity());
+	size_t buffered = 0;
+	size_t triangles = 0;
+
+	//Only the vertices of the data are used, it gives the same memory accounting as the loader
+	D3Data data;
+	std::vector<Vertex>& vertices = data.vertices;
+	size_t capacities[6] = { 0, 0, 0, 0, 0, 0 };
+	memory_tracker = tracker;
+
+	std::string line;
+	int line_num = 0;
+	try
+	{
+		Vertex vtemp;
+		Face ftemp;
+		//Vertex indexes of the current face
+		std::vector<long> corners;
+		FaceParser face_parser = nullptr;
+		bool generic_faces = false;
+		std::string::size_type sz;
+		std::string::size_type pos;
+		while (getline(objfile, line))
+		{
+			line_num += 1;
+			if (line.size() >= 2 && line[0] == 'v' && line[1] == ' ')
+			{
+				sz = pos = 2;
+				vtemp.x = std::stof(line.substr(pos), &sz);
+				pos += sz;
+				vtemp.y = std::stof(line.substr(pos), &sz);
+				pos += sz;
+				vtemp.z = std::stof(line.substr(pos), &sz);
+				vtemp.w = 0;
+				vertices.push_back(vtemp);
+			}
+			else if (line.size() >= 2 && line[0] == 'f' && line[1] == ' ')
+			{
+				//Parsed the same way as in CheckedObjLoader, so both accept the same files
+				corners.clear();
+				if (triangulate && Utils::count_occurences(line.substr(2), ' ') > 2)
+				{
+					std::vector<VertexData> vdata = tokenize_obj_face_line(line.substr(2));
+					for (size_t i = 0; i < vdata.size(); i++) corners.push_back(vdata[i].vertex_index);
+				}
+				else
+				{
+					if (fast_face_parsing && face_parser == nullptr && !generic_faces)
+					{
+						face_parser = face_parser_for(line);
+						generic_faces = face_parser == nullptr;
+					}
+					if (face_parser == nullptr || !face_parser(line.c_str() + 2, ftemp))
+					{
+						face_parser = nullptr;
+						generic_faces = true;
+						parse_face_generic(line, ftemp, line_num);
+					}
+					corners.push_back(ftemp.V1);
+					corners.push_back(ftemp.V2);
+					corners.push_back(ftemp.V3);
+				}
+				if (corners.size() < 3)
+					throw InvalidFormatException(("Invalid face format. Line: " + std::to_string(line_num)).c_str());
+				//Fixing negative indexes and checking the range
+				for (size_t i = 0; i < corners.size(); i++)
+				{
+					long& v = corners[i];
+					if (v < 0) v += (long)vertices.size() + 1;
+					if (v < 1 || v >(long)vertices.size())
+						throw InvalidFormatException(("Out of range index in face. Line: " + std::to_string(line_num)).c_str());
+				}
+				//Fan triangulation from the first vertex
+				CachedFace face;
+				face.V1 = &vertices[corners[0] - 1];
+				for (size_t i = 2; i < corners.size(); i++)
+				{
+					//The count is stored on 32 bits, checked before anything past it is written
+					if (triangles == UINT32_MAX)
+						throw InvalidFormatException("Too many triangles for a binary stl file");
+					face.V2 = &vertices[corners[i - 1] - 1];
+					face.V3 = &vertices[corners[i] - 1];
+					packFace(&buffer[buffered * face_record_size], face, n_type);
+					++triangles;
+					if (++buffered == buffer_faces)
+					{
+						outfile.write(&buffer[0], buffered * face_record_size);
+						buffered = 0;
+					}
+				}
+			}
+			//Normals, texcoords and anything else are skipped
+			//The growth of the vertex storage and the line buffer is registered like in the loader
+			if (tracker) track_growth(data, line, capacities);
+		}
+	}
+	//Invalid argument or out of range exception from stof or stol meaning invalid formatting
+	catch (const std::invalid_argument&)
+	{
+		throw(InvalidFormatException(("Bad number formatting. Line: " + std::to_string(line_num)).c_str()));
+	}
+	catch (const std::out_of_range&)
+	{
+		throw(InvalidFormatException(("Bad number formatting. Line: " + std::to_string(line_num)).c_str()));
+	}
+
+	if (buffered > 0) outfile.write(&buffer[0], buffered * face_record_size);
+	//Going back to the triangle count after the 80 byte header
+	outfile.seekp(0);
+	writeHeader(outfile, (uint32_t)triangles);
+	outfile.seekp(0, std::ios::end);
+
+	if (tracker)
+	{
+		tracker->release(buffer.capacity());
+		tracker->release(capacities[0]);
+		tracker->release(capacities[5]);
+	}
+	return triangles;
+}
@@ -0,0 +1,35 @@
+#ifndef UNIQUE_StreamingObjStlConverter
+#define UNIQUE_StreamingObjStlConverter
+#include "ObjLoader.h"
+#include "StlWriter.h"
+#include "MemoryTracker.h"
+namespace FormatConverter {
+	/*
+	Converts an obj file into a binary stl file in one pass.
+	Only the vertices are kept in memory, the faces are written out
+	as soon as they are parsed, normals and texcoords are skipped.
+	Uses the parsing of CheckedObjLoader and the
+	output format of StlWriter.
+	*/
+	class StreamingObjStlConverter : protected CheckedObjLoader, protected StlWriter {
+	public:
+		/*
+		Converts the obj on in_path into the stl on out_path, returns the number
+		of written triangles. Indexes are always checked and negative ones fixed.
+		n_type works like in StlWriter, but 'a' falls back to 'c', because normals
+		are not stored. Polygons are triangulated if triangulate is set, otherwise
+		only their first 3 vertices are used, like in CheckedObjLoader.
+		If tracker is given, the vertex storage, the line buffer and the output buffer are
+		registered in it, growth is counted like in CheckedObjLoader::set_memory_tracker.
+		Throws FileException and InvalidFormatException, also if the triangles would not
+		fit the 32 bit count of the format. On errors the output file is removed.
+		*/
+		size_t convert(std::string& in_path, std::string& out_path, char n_type = 'c',
+			bool triangulate = false, MemoryTracker* tracker = nullptr);
+
+		//Stream version of the above, the output has to be binary and seekable
+		size_t convert(std::istream& in, std::ostream& out, char n_type = 'c',
+			bool triangulate = false, MemoryTracker* tracker = nullptr);
+	};
+}
+#endif
@@ -0,0 +1,209 @@
+#include "TextFormat.h"
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+using namespace FormatConverter;
+
+//Powers of ten as doubles, the ones up to 1e22 are exact
+struct PowerTable
+{
+	double values[2 * 340 + 1];
+	PowerTable()
+	{
+		for (int i = -340; i <= 340; i++) values[i + 340] = pow(10.0, i);
+	}
+};
+
+//The table is created once, the initialization of the static is thread safe
+static double power_of_ten(int e)
+{
+	static const PowerTable table;
+	return table.values[e + 340];
+}
+
+//Writes the digits of an unsigned number, returns their count
+static size_t write_digits(unsigned long long value, char* out)
+{
+	char temp[24];
+	size_t n = 0;
+	do
+	{
+		temp[n++] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value > 0);
+	for (size_t i = 0; i < n; i++) out[i] = temp[n - 1 - i];
+	return n;
+}
+
+//Writes an integer in decimal
+size_t FormatConverter::TextFormat::int_to_chars(long long value, char * out)
+{
+	if (value < 0)
+	{
+		out[0] = '-';
+		//Negating as unsigned, so the smallest value works too
+		return 1 + write_digits(0ull - (unsigned long long)value, out + 1);
+	}
+	return write_digits((unsigned long long)value, out);
+}
+
+//Integer powers of ten up to 10^9
+static const unsigned long long int_powers[10] = { 1ull, 10ull, 100ull, 1000ull, 10000ull,
+	100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull };
+
+/*
+Every decimal strictly between the midpoints to the neighbouring floats reads back
+as value. The value and the midpoints are scaled to 9 digits, where the interval always
+contains integers, then the shortest digits are the multiple of the biggest power of ten
+inside the interval. The midpoints are exact in double, but scaling rounds them a little,
+so integers on or very close to a scaled midpoint are checked by reading them back with
+strtof, which also applies the round half to even rule.
+*/
+size_t FormatConverter::TextFormat::float_to_chars(float value, char * out)
+{
+	if (value != value)
+	{
+		memcpy(out, "nan", 3);
+		return 3;
+	}
+	size_t n = 0;
+	if (value < 0 || (value == 0 && 1 / value < 0))
+	{
+		out[n++] = '-';
+		value = -value;
+	}
+	if (value == 0)
+	{
+		out[n++] = '0';
+		return n;
+	}
+	if (value > FLT_MAX)
+	{
+		memcpy(out + n, "inf", 3);
+		return n + 3;
+	}
+
+	//Neighbouring floats from the bit pattern, the value is positive here
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint32_t below_bits = bits - 1, above_bits = bits + 1;
+	float below, above;
+	memcpy(&below, &below_bits, sizeof(below));
+	memcpy(&above, &above_bits, sizeof(above));
+	const double v = value;
+	double lo = (v + below) / 2;
+	double hi = value == FLT_MAX ? v + (v - below) / 2 : (v + above) / 2;
+
+	//Decimal exponent estimated from the binary one, then corrected
+	int exponent;
+	frexp(v, &exponent);
+	int e10 = (int)floor((exponent - 1) * 0.30102999566398120);
+	while (power_of_ten(e10) > v) --e10;
+	while (power_of_ten(e10 + 1) <= v) ++e10;
+
+	//Scaling to 9 digits, with a division for negative scales to keep the exact powers
+	int scale = 8 - e10;
+	const double p = power_of_ten(scale < 0 ? -scale : scale);
+	double scaled = scale >= 0 ? v * p : v / p;
+	lo = scale >= 0 ? lo * p : lo / p;
+	hi = scale >= 0 ? hi * p : hi / p;
+
+	//Integer range of the interval, boundaries close to an integer are ambiguous
+	const double eps = 1e-6;
+	unsigned long long low = (unsigned long long)ceil(lo - eps);
+	unsigned long long high = (unsigned long long)floor(hi + eps);
+	bool low_exact = fabs(lo - (double)low) < eps;
+	bool high_exact = fabs(hi - (double)high) < eps;
+
+	//Reads back digits * 10^-scale
+	auto reads_back = [&](unsigned long long digits, int digit_scale) -> bool
+	{
+		char temp[max_length];
+		size_t len = write_digits(digits, temp);
+		temp[len++] = 'e';
+		len += int_to_chars(-digit_scale, temp + len);
+		temp[len] = '\0';
+		return strtof(temp, nullptr) == value;
+	};
+	//Deciding the ambiguous boundaries exactly, this is rare
+	if (low_exact && !reads_back(low, scale)) ++low;
+	if (high_exact && !reads_back(high, scale)) --high;
+
+	//Binary search for the biggest power of ten with a multiple in [low, high]
+	int k_min = 0, k_max = 9;
+	while (k_min + 1 < k_max)
+	{
+		int k = (k_min + k_max) / 2;
+		unsigned long long m = int_powers[k];
+		if ((low + m - 1) / m * m <= high) k_min = k;
+		else k_max = k;
+	}
+	//The multiple closest to the value
+	unsigned long long m = int_powers[k_min];
+	unsigned long long first_multiple = (low + m - 1) / m;
+	unsigned long long last_multiple = high / m;
+	unsigned long long nearest = (unsigned long long)floor(scaled / m + 0.5);
+	if (nearest < first_multiple) nearest = first_multiple;
+	if (nearest > last_multiple) nearest = last_multiple;
+	unsigned long long digits = nearest;
+	scale -= k_min;
+
+	//Removing trailing zeros, the value is digits * 10^-scale
+	while (digits % 10 == 0)
+	{
+		digits /= 10;
+		--scale;
+	}
+	char d[24];
+	int count = (int)write_digits(digits, d);
+	//Exponent of the first digit
+	int first = count - 1 - scale;
+
+	if (first >= -5 && first < 9)
+	{
+		if (first < 0)
+		{
+			//0.000ddd
+			out[n++] = '0';
+			out[n++] = '.';
+			for (int i = -1; i > first; i--) out[n++] = '0';
+			memcpy(out + n, d, count);
+			n += count;
+		}
+		else if (count <= first + 1)
+		{
+			//ddd000
+			memcpy(out + n, d, count);
+			n += count;
+			for (int i = count; i <= first; i++) out[n++] = '0';
+		}
+		else
+		{
+			//dd.ddd
+			memcpy(out + n, d, first + 1);
+			n += first + 1;
+			out[n++] = '.';
+			memcpy(out + n, d + first + 1, count - first - 1);
+			n += count - first - 1;
+		}
+	}
+	else
+	{
+		//d.ddde+xx
+		out[n++] = d[0];
+		if (count > 1)
+		{
+			out[n++] = '.';
+			memcpy(out + n, d + 1, count - 1);
+			n += count - 1;
+		}
+		out[n++] = 'e';
+		out[n++] = first < 0 ? '-' : '+';
+		int a = first < 0 ? -first : first;
+		if (a < 10) out[n++] = '0';
+		n += write_digits(a, out + n);
+	}
+	return n;
+}
@@ -0,0 +1,26 @@
+#ifndef UNIQUE_TextFormat
+#define UNIQUE_TextFormat
+#include <cstddef>
+namespace FormatConverter {
+	/*
+	Static utility class for fast number formatting into character buffers,
+	used by the text writers instead of streams.
+	*/
+	class TextFormat {
+	public:
+		//Longest output of the functions, including room for a terminating zero
+		static const size_t max_length = 32;
+
+		/*
+		Writes the shortest decimal form of value that reads back as the same float,
+		returns the number of written characters (no terminating zero is written).
+		Uses plain notation for moderate exponents and scientific notation otherwise,
+		like 0.125, 3.1415927, 1e+20, 1.5e-07.
+		*/
+		static size_t float_to_chars(float value, char* out);
+
+		//Writes an integer in decimal, returns the number of written characters
+		static size_t int_to_chars(long long value, char* out);
+	};
+}
+#endif